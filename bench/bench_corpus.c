@@ -0,0 +1,437 @@
+#define _POSIX_C_SOURCE 200809L
+#include <locale.h>
+#include <ncurses.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tekstitv.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../lib/html_tokens.h"
+#include "../src/config.h"
+#include "../src/drawer.h"
+#include "../src/printer.h"
+
+#define PAGES_DIR "bench/pages"
+#define PARSE_ROUNDS 5000
+#define DECODE_ROUNDS 5000
+#define PRINT_ROUNDS 2000
+#define DRAW_ROUNDS 500
+#define HISTORY_ROUNDS 500
+
+// Recorded pages of different kinds, run from the repository root
+static const char* page_names[] = {
+    "index",
+    "news",
+    "article",
+    "sports",
+    "weather",
+    // "YLE Teleport" page that is returned for missing pages
+    "invalid",
+};
+
+// Links the pages are opened with from the page cache
+static char* page_links[] = {
+    "100_0001.htm",
+    "101_0001.htm",
+    "102_0001.htm",
+    "235_0001.htm",
+    "400_0001.htm",
+    "999_0001.htm",
+};
+
+#define PAGE_COUNT (sizeof(page_names) / sizeof(page_names[0]))
+
+typedef struct {
+    const char* name;
+    char* html;
+    size_t size;
+} corpus_page;
+
+#if defined(__GLIBC__) && !defined(__UCLIBC__) && !defined(__SANITIZE_ADDRESS__)
+// Count the allocations by replacing malloc with a wrapper around glibc's malloc.
+// Other C libraries like musl, bionic and uClibc (which also defines __GLIBC__)
+// don't have the __libc_ functions, and sanitizers replace malloc themselves,
+// so the allocations aren't counted there
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+
+static size_t allocations = 0;
+
+void* malloc(size_t size)
+{
+    allocations++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    allocations++;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    allocations++;
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr)
+{
+    __libc_free(ptr);
+}
+
+#define ALLOCATIONS_COUNTED true
+#else
+static size_t allocations = 0;
+#define ALLOCATIONS_COUNTED false
+#endif
+
+typedef struct {
+    struct timespec start;
+    size_t allocations;
+} measurement;
+
+static void start_measurement(measurement* m)
+{
+    m->allocations = allocations;
+    clock_gettime(CLOCK_MONOTONIC, &m->start);
+}
+
+static void print_measurement(FILE* out, measurement* m, const char* name, size_t bytes, size_t rounds)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double ns = (end.tv_sec - m->start.tv_sec) * 1e9 + (end.tv_nsec - m->start.tv_nsec);
+    double page_ns = ns / rounds;
+    double mb_per_s = (double)bytes * rounds / (ns / 1e9) / (1024 * 1024);
+
+    fprintf(out, "  %-10s %6zu bytes %10.0f ns/page %10.2f MB/s", name, bytes, page_ns, mb_per_s);
+    if (ALLOCATIONS_COUNTED)
+        fprintf(out, " %8.2f allocs/page\n", (double)(allocations - m->allocations) / rounds);
+    else
+        fprintf(out, "        - allocs/page\n");
+}
+
+static bool read_page(corpus_page* page, const char* name)
+{
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s.htm", PAGES_DIR, name);
+    FILE* fp = fopen(path, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return false;
+    }
+
+    html_buffer buffer = { 0 };
+    buffer.limit = HTML_BUFFER_DEFAULT_LIMIT;
+    char chunk[4096];
+    size_t read;
+    while ((read = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+        html_buffer_append(&buffer, chunk, read);
+    fclose(fp);
+
+    page->name = name;
+    page->html = buffer.html;
+    page->size = buffer.size;
+    return true;
+}
+
+/**
+ * Parse the page like a page load does, the parser is reused between the pages
+ */
+static void load_corpus_page(html_parser* parser, corpus_page* page)
+{
+    reset_html_parser(parser);
+    html_buffer_append(&parser->_curl_buffer, page->html, page->size);
+    parse_html(parser);
+}
+
+static void bench_parse(FILE* out, corpus_page* pages)
+{
+    fprintf(out, "parse_html: %d rounds\n", PARSE_ROUNDS);
+    html_parser parser;
+    init_html_parser(&parser);
+    for (size_t i = 0; i < PAGE_COUNT; i++) {
+        // Warm up so the parser has grown to fit the page
+        load_corpus_page(&parser, &pages[i]);
+
+        measurement m;
+        start_measurement(&m);
+        for (size_t round = 0; round < PARSE_ROUNDS; round++)
+            load_corpus_page(&parser, &pages[i]);
+        print_measurement(out, &m, pages[i].name, pages[i].size, PARSE_ROUNDS);
+    }
+    free_html_parser(&parser);
+}
+
+/**
+ * Decode every text between the tags of the page, split to the
+ * size of the parser's texts
+ */
+static void bench_decode(FILE* out, corpus_page* pages)
+{
+    fprintf(out, "entity decoding: %d rounds\n", DECODE_ROUNDS);
+    char target[HTML_TEXT_MAX];
+    size_t decoded = 0;
+    for (size_t i = 0; i < PAGE_COUNT; i++) {
+        const char* html = pages[i].html;
+        size_t size = pages[i].size;
+        size_t text_bytes = 0;
+
+        measurement m;
+        start_measurement(&m);
+        for (size_t round = 0; round < DECODE_ROUNDS; round++) {
+            text_bytes = 0;
+            size_t pos = 0;
+            while (pos < size) {
+                // Skip the tag
+                while (pos < size && html[pos] != '>')
+                    pos++;
+                pos++;
+
+                size_t start = pos;
+                while (pos < size && html[pos] != '<')
+                    pos++;
+
+                for (size_t text = start; text < pos; text += HTML_TEXT_MAX - 1) {
+                    size_t len = pos - text < HTML_TEXT_MAX - 1 ? pos - text : HTML_TEXT_MAX - 1;
+                    decoded += copy_html_text(target, html + text, len);
+                }
+                text_bytes += pos - start;
+            }
+        }
+        print_measurement(out, &m, pages[i].name, text_bytes, DECODE_ROUNDS);
+    }
+
+    // Keep the decoding from being optimized away
+    if (decoded == 0)
+        fprintf(out, "  nothing was decoded\n");
+}
+
+static void bench_print(FILE* out, corpus_page* pages, const config* conf)
+{
+    fprintf(out, "print_parser: %d rounds\n", PRINT_ROUNDS);
+    html_parser parser;
+    init_html_parser(&parser);
+    for (size_t i = 0; i < PAGE_COUNT; i++) {
+        load_corpus_page(&parser, &pages[i]);
+
+        measurement m;
+        start_measurement(&m);
+        for (size_t round = 0; round < PRINT_ROUNDS; round++)
+            print_parser(conf, &parser);
+        fflush(stdout);
+        print_measurement(out, &m, pages[i].name, pages[i].size, PRINT_ROUNDS);
+    }
+    free_html_parser(&parser);
+}
+
+/**
+ * Bytes the terminal has received since the last call
+ */
+static long terminal_bytes(FILE* terminal, long* total)
+{
+    fflush(terminal);
+    long now = ftell(terminal);
+    long bytes = now - *total;
+    *total = now;
+    return bytes;
+}
+
+static void print_navigation(FILE* out, measurement* m, const char* name, long bytes, size_t moves)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double ns = (end.tv_sec - m->start.tv_sec) * 1e9 + (end.tv_nsec - m->start.tv_nsec);
+    fprintf(out, "  %-24s %10.0f ns/page %6ld bytes/page\n", name, ns / moves, bytes / (long)moves);
+}
+
+/**
+ * Open the pages from the page cache and go back and forth in the history.
+ * The pages that were left are shown from the history without laying them
+ * out again, opening them from the page cache is measured for comparison.
+ */
+static void bench_history(FILE* out, drawer* drawer, html_parser* parser, corpus_page* pages, FILE* terminal)
+{
+    fprintf(out, "history navigation: %d rounds\n", HISTORY_ROUNDS);
+    char* links[PAGE_COUNT];
+    size_t count = 0;
+    init_page_cache(&drawer->cache, PAGE_COUNT, 0);
+    for (size_t i = 0; i < PAGE_COUNT; i++) {
+        load_corpus_page(parser, &pages[i]);
+        // Load error pages wait for the keys
+        if (parser->curl_load_error)
+            continue;
+        link_from_short_link(parser, page_links[i]);
+        page_cache_put(&drawer->cache, parser);
+        links[count++] = page_links[i];
+    }
+
+    drawer->page_index = -1;
+    for (size_t i = 0; i < count; i++) {
+        link_from_short_link(parser, links[i]);
+        load_link(drawer, parser, true);
+    }
+
+    long total = 0;
+    terminal_bytes(terminal, &total);
+    measurement m;
+    start_measurement(&m);
+    for (size_t round = 0; round < HISTORY_ROUNDS; round++) {
+        for (size_t i = 1; i < count; i++)
+            load_prev_link(drawer, parser);
+        for (size_t i = 1; i < count; i++)
+            load_next_link(drawer, parser);
+    }
+    size_t moves = HISTORY_ROUNDS * (count - 1) * 2;
+    print_navigation(out, &m, "back and forward", terminal_bytes(terminal, &total), moves);
+
+    start_measurement(&m);
+    for (size_t round = 0; round < HISTORY_ROUNDS; round++) {
+        for (size_t i = 0; i < count; i++) {
+            link_from_short_link(parser, links[count - 1 - i]);
+            load_link(drawer, parser, false);
+        }
+    }
+    print_navigation(out, &m, "from the page cache", terminal_bytes(terminal, &total), HISTORY_ROUNDS * count);
+
+    free_page_cache(&drawer->cache);
+}
+
+/**
+ * Draw the pages with a terminal that writes to a temporary file, so the
+ * bytes sent to the terminal can be counted too
+ */
+static void bench_draw(FILE* out, corpus_page* pages, const config* conf)
+{
+    fprintf(out, "draw_page: %d rounds\n", DRAW_ROUNDS);
+
+    // Same size and encoding as a typical terminal window
+    setlocale(LC_ALL, "C.UTF-8");
+    setenv("LINES", "40", 1);
+    setenv("COLUMNS", "100", 1);
+    FILE* null = fopen("/dev/null", "r");
+    FILE* terminal = tmpfile();
+    SCREEN* screen = null != NULL && terminal != NULL ? newterm("xterm", terminal, null) : NULL;
+    if (screen == NULL) {
+        fprintf(out, "  skipped, cannot open a headless xterm\n");
+        if (null != NULL)
+            fclose(null);
+        if (terminal != NULL)
+            fclose(terminal);
+        return;
+    }
+
+    // Same state init_drawer and set_main_window_size set, without the
+    // prefetcher and the loader
+    drawer drawer;
+    memset(&drawer, 0, sizeof(drawer));
+    drawer.config = conf;
+    drawer.w_width = COLS > 80 ? 80 : COLS;
+    drawer.w_height = LINES - 1;
+    drawer.window_start_x = (COLS - drawer.w_width) / 2;
+    drawer.window_start_y = 1;
+    // Links are drawn with attributes like in a color terminal
+    drawer.color_support = has_colors();
+    drawer.text_color = -1;
+    drawer.link_color = -1;
+    drawer.background_color = -1;
+    drawer.highlight_row = -1;
+    drawer.highlight_col = -1;
+    drawer.page_index = -1;
+    init_browser_history(&drawer.history);
+    drawer.info_window = newwin(1, drawer.w_width, 0, 0);
+    drawer.window = newwin(drawer.w_height, drawer.w_width, drawer.window_start_y, drawer.window_start_x);
+
+    html_parser parser;
+    init_html_parser(&parser);
+    for (size_t i = 0; i < PAGE_COUNT; i++) {
+        load_corpus_page(&parser, &pages[i]);
+        // Invalid pages are drawn with the interactive error screen
+        if (parser.curl_load_error) {
+            fprintf(out, "  %-10s skipped, load error page\n", pages[i].name);
+            continue;
+        }
+
+        draw_page(&drawer, &parser, true);
+        measurement m;
+        start_measurement(&m);
+        for (size_t round = 0; round < DRAW_ROUNDS; round++)
+            draw_page(&drawer, &parser, true);
+        print_measurement(out, &m, pages[i].name, pages[i].size, DRAW_ROUNDS);
+    }
+
+    // Bytes sent to the terminal by the common screen changes
+    fprintf(out, "terminal output:\n");
+    long total = 0;
+    terminal_bytes(terminal, &total);
+    load_corpus_page(&parser, &pages[0]);
+    // Same as clearing the window before drawing
+    clearok(drawer.window, TRUE);
+    draw_page(&drawer, &parser, true);
+    fprintf(out, "  %-24s %6ld bytes\n", "whole page repainted", terminal_bytes(terminal, &total));
+    draw_page(&drawer, &parser, true);
+    fprintf(out, "  %-24s %6ld bytes\n", "same page again", terminal_bytes(terminal, &total));
+    draw_highlight(&drawer, 1, 0);
+    draw_highlight(&drawer, 2, 0);
+    fprintf(out, "  %-24s %6ld bytes\n", "highlight moved", terminal_bytes(terminal, &total) / 2);
+    for (size_t i = 1; i < PAGE_COUNT; i++) {
+        load_corpus_page(&parser, &pages[i]);
+        if (parser.curl_load_error)
+            continue;
+        draw_page(&drawer, &parser, true);
+        char name[64];
+        snprintf(name, sizeof(name), "%s after %s", pages[i].name, pages[i - 1].name);
+        fprintf(out, "  %-24s %6ld bytes\n", name, terminal_bytes(terminal, &total));
+    }
+
+    bench_history(out, &drawer, &parser, pages, terminal);
+    free_html_parser(&parser);
+
+    delwin(drawer.window);
+    delwin(drawer.info_window);
+    free(drawer.highlight_rows);
+    free(drawer.highlight_links);
+    free(drawer.link_grid);
+    free(drawer.frame.runs);
+    free(drawer.frame.text);
+    free(drawer.shown.runs);
+    free(drawer.shown.text);
+    free_browser_history(&drawer.history);
+    endwin();
+    delscreen(screen);
+    fclose(null);
+    fclose(terminal);
+}
+
+int main(void)
+{
+    corpus_page pages[PAGE_COUNT];
+    for (size_t i = 0; i < PAGE_COUNT; i++) {
+        if (!read_page(&pages[i], page_names[i]))
+            return 1;
+    }
+
+    // Results are written to the original stdout, the printed pages to /dev/null
+    FILE* out = fdopen(dup(STDOUT_FILENO), "w");
+    if (out == NULL || freopen("/dev/null", "w", stdout) == NULL) {
+        fprintf(stderr, "Cannot redirect stdout\n");
+        return 1;
+    }
+
+    config conf = global_config;
+    fprintf(out, "corpus: %zu pages from %s\n", PAGE_COUNT, PAGES_DIR);
+    bench_parse(out, pages);
+    bench_decode(out, pages);
+    bench_print(out, pages, &conf);
+    bench_draw(out, pages, &conf);
+
+    for (size_t i = 0; i < PAGE_COUNT; i++)
+        free(pages[i].html);
+    fclose(out);
+    return 0;
+}
@@ -0,0 +1,63 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tekstitv.h>
+#include <time.h>
+
+#include "../lib/html_tokens.h"
+
+#define ROUNDS 200000
+
+// Middle rows as they are found in the tekstitv pages, entities included
+static const char* texts[] = {
+    " J&auml;rjest&ouml;t vaativat lis&auml;&auml; rahaa",
+    " S&auml;&auml; paikkakunnittain",
+    " P&Auml;&Auml;HAKEMISTO",
+    " Sein&auml;joki&ndash;Jyv&auml;skyl&auml; 2&ndash;1",
+    " L&auml;mp&ouml;tila +12&deg;C, tuuli 5 m/s",
+    " Kurssi 1,1834 &euro; (&plusmn;0,2 &#37;)",
+    " Se&ntilde;or &Aring;kesson &amp; Kova&#269;",
+    " Marin: Maskiasiassa ei valehdeltu",
+    " Lukashenka tapasi oppositiovankeja",
+    " Valtteri Bottas keskeytti Saksassa",
+};
+
+static double elapsed_ns(struct timespec start, struct timespec end)
+{
+    return (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+}
+
+int main(void)
+{
+    size_t text_count = sizeof(texts) / sizeof(texts[0]);
+    size_t bytes = 0;
+    size_t entities = 0;
+    for (size_t i = 0; i < text_count; i++) {
+        bytes += strlen(texts[i]);
+        for (const char* c = texts[i]; *c != '\0'; c++) {
+            if (*c == '&')
+                entities++;
+        }
+    }
+
+    char target[HTML_TEXT_MAX];
+    size_t decoded = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t round = 0; round < ROUNDS; round++) {
+        for (size_t i = 0; i < text_count; i++) {
+            decoded += copy_html_text(target, texts[i], strlen(texts[i]));
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double total_ns = elapsed_ns(start, end);
+    double total_bytes = (double)bytes * ROUNDS;
+    printf("entity decoding: %zu bytes, %zu entities, %d rounds (%zu decoded)\n", bytes, entities, ROUNDS, decoded);
+    printf("  %8.2f ns/byte\n", total_ns / total_bytes);
+    printf("  %8.2f ns/entity\n", total_ns / ((double)entities * ROUNDS));
+    printf("  %8.2f MB/s\n", total_bytes / (total_ns / 1e9) / (1024 * 1024));
+
+    return 0;
+}
@@ -0,0 +1,233 @@
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tekstitv.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PAGES_DIR "bench/pages"
+#define MEMORY_ROUNDS 5000
+#define FILE_ROUNDS 500
+#define LATENCY_MS 2
+#define LATENCY_LOADS 256
+
+// Same corpus as bench_corpus, every page gets its own link
+static const char* page_names[] = { "index", "news", "article", "sports", "weather", "invalid" };
+static char* page_links[] = {
+    "100_0001.htm",
+    "101_0001.htm",
+    "102_0001.htm",
+    "235_0001.htm",
+    "400_0001.htm",
+    "999_0001.htm",
+};
+
+#define PAGE_COUNT (sizeof(page_names) / sizeof(page_names[0]))
+
+typedef struct {
+    page_memory_map* map;
+    size_t loads;
+} load_thread;
+
+static double elapsed_ns(struct timespec start)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+}
+
+static bool read_page(page_memory_entry* entry, const char* name, const char* link)
+{
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s.htm", PAGES_DIR, name);
+    FILE* fp = fopen(path, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return false;
+    }
+
+    html_buffer buffer = { 0 };
+    buffer.limit = HTML_BUFFER_DEFAULT_LIMIT;
+    char chunk[4096];
+    size_t read;
+    while ((read = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+        html_buffer_append(&buffer, chunk, read);
+    fclose(fp);
+
+    entry->link = link;
+    entry->html = buffer.html;
+    entry->size = buffer.size;
+    return true;
+}
+
+/**
+ * Load every page of the corpus through the loader, the parser is reused
+ */
+static void load_corpus(page_loader* loader, html_parser* parser)
+{
+    for (size_t i = 0; i < PAGE_COUNT; i++) {
+        link_from_short_link(parser, page_links[i]);
+        loader_load_page(loader, parser);
+    }
+}
+
+static void bench_transport(const char* name, page_loader* loader, size_t rounds)
+{
+    html_parser parser;
+    init_html_parser(&parser);
+    // Warm up so the parser has grown to fit the pages
+    load_corpus(loader, &parser);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t round = 0; round < rounds; round++)
+        load_corpus(loader, &parser);
+    double ns = elapsed_ns(start);
+    printf("  %-22s %10.0f ns/page\n", name, ns / (rounds * PAGE_COUNT));
+    free_html_parser(&parser);
+}
+
+static void* run_load_thread(void* data)
+{
+    load_thread* thread = data;
+    page_loader loader;
+    init_page_loader(&loader);
+    loader_use_fetch(&loader, page_memory_fetch, thread->map);
+
+    html_parser parser;
+    init_html_parser(&parser);
+    for (size_t i = 0; i < thread->loads; i++) {
+        link_from_short_link(&parser, page_links[i % PAGE_COUNT]);
+        loader_load_page(&loader, &parser);
+    }
+    free_html_parser(&parser);
+    free_page_loader(&loader);
+    return NULL;
+}
+
+/**
+ * Share the loads between loader threads, like the prefetcher does,
+ * while every load waits for the simulated network
+ */
+static void bench_latency(page_memory_map* map, size_t threads)
+{
+    pthread_t ids[16];
+    load_thread loads[16];
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < threads; i++) {
+        loads[i].map = map;
+        loads[i].loads = LATENCY_LOADS / threads;
+        pthread_create(&ids[i], NULL, run_load_thread, &loads[i]);
+    }
+    for (size_t i = 0; i < threads; i++)
+        pthread_join(ids[i], NULL);
+
+    double seconds = elapsed_ns(start) / 1e9;
+    printf("  %2zu threads %21.0f pages/s\n", threads, LATENCY_LOADS / seconds);
+}
+
+static void bench_batch(const char* base_url, long concurrency)
+{
+    page_batch_options options = { 0 };
+    options.base_url = base_url;
+    options.max_concurrency = concurrency;
+    html_parser parsers[PAGE_COUNT];
+    for (size_t i = 0; i < PAGE_COUNT; i++)
+        init_html_parser(&parsers[i]);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t round = 0; round < FILE_ROUNDS; round++)
+        load_page_batch(options, page_links, parsers, PAGE_COUNT);
+    double ns = elapsed_ns(start);
+    char name[32];
+    snprintf(name, sizeof(name), "%ld connections", concurrency);
+    printf("  %-22s %10.0f ns/page\n", name, ns / (FILE_ROUNDS * PAGE_COUNT));
+
+    for (size_t i = 0; i < PAGE_COUNT; i++)
+        free_html_parser(&parsers[i]);
+}
+
+/**
+ * Write the corpus to a temporary directory with the page links as the file names
+ */
+static bool write_page_dir(char* dir, page_memory_entry* pages)
+{
+    if (mkdtemp(dir) == NULL)
+        return false;
+
+    for (size_t i = 0; i < PAGE_COUNT; i++) {
+        char path[PAGE_LOADER_URL_MAX];
+        snprintf(path, sizeof(path), "%s/%s", dir, pages[i].link);
+        FILE* fp = fopen(path, "w");
+        if (fp == NULL)
+            return false;
+        fwrite(pages[i].html, 1, pages[i].size, fp);
+        fclose(fp);
+    }
+    return true;
+}
+
+static void remove_page_dir(const char* dir, page_memory_entry* pages)
+{
+    for (size_t i = 0; i < PAGE_COUNT; i++) {
+        char path[PAGE_LOADER_URL_MAX];
+        snprintf(path, sizeof(path), "%s/%s", dir, pages[i].link);
+        unlink(path);
+    }
+    rmdir(dir);
+}
+
+int main(void)
+{
+    page_memory_entry pages[PAGE_COUNT];
+    for (size_t i = 0; i < PAGE_COUNT; i++) {
+        if (!read_page(&pages[i], page_names[i], page_links[i]))
+            return 1;
+    }
+
+    if (!init_tekstitv())
+        return 1;
+
+    page_memory_map map = { pages, PAGE_COUNT, 0 };
+    page_loader loader;
+    init_page_loader(&loader);
+
+    printf("loader_load_page: %zu pages from %s\n", PAGE_COUNT, PAGES_DIR);
+    loader_use_fetch(&loader, page_memory_fetch, &map);
+    bench_transport("memory", &loader, MEMORY_ROUNDS);
+
+    char dir[] = "/tmp/tekstitv-bench-XXXXXX";
+    char url[PAGE_LOADER_URL_MAX];
+    bool has_dir = write_page_dir(dir, pages);
+    snprintf(url, sizeof(url), "file://%s/", dir);
+    if (has_dir) {
+        loader_use_fetch(&loader, NULL, NULL);
+        loader_set_base_url(&loader, url);
+        bench_transport("file://", &loader, FILE_ROUNDS);
+    } else {
+        printf("  file:// skipped, cannot write the pages to %s\n", dir);
+    }
+    free_page_loader(&loader);
+
+    printf("memory with %d ms latency: %d loads\n", LATENCY_MS, LATENCY_LOADS);
+    map.latency_ms = LATENCY_MS;
+    bench_latency(&map, 1);
+    bench_latency(&map, 4);
+    bench_latency(&map, 16);
+
+    if (has_dir) {
+        printf("load_page_batch from file://: %d rounds\n", FILE_ROUNDS);
+        bench_batch(url, 1);
+        bench_batch(url, PAGE_BATCH_MAX_CONCURRENCY);
+        remove_page_dir(dir, pages);
+    }
+
+    for (size_t i = 0; i < PAGE_COUNT; i++)
+        free((char*)pages[i].html);
+    free_tekstitv();
+    return 0;
+}
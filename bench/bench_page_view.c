@@ -0,0 +1,73 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tekstitv.h>
+#include <time.h>
+
+#define PAGE_PATH "tests/test_html/100.htm"
+#define ROUNDS 20000
+
+static double elapsed_ns(struct timespec start, struct timespec end)
+{
+    return (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+}
+
+int main(void)
+{
+    FILE* fp = fopen(PAGE_PATH, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "Cannot open %s\n", PAGE_PATH);
+        return 1;
+    }
+
+    html_buffer page = { 0 };
+    page.limit = HTML_BUFFER_DEFAULT_LIMIT;
+    char chunk[4096];
+    size_t read;
+    while ((read = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+        html_buffer_append(&page, chunk, read);
+    fclose(fp);
+
+    struct timespec start, end;
+    size_t rows = 0;
+    size_t parser_bytes = 0;
+
+    // The copying parser, as a page load uses it
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t round = 0; round < ROUNDS; round++) {
+        html_parser parser;
+        init_html_parser(&parser);
+        html_buffer_append(&parser._curl_buffer, page.html, page.size);
+        parse_html(&parser);
+        rows += parser.middle_rows;
+        parser_bytes = sizeof(html_parser) + parser.middle_rows * sizeof(html_row)
+            + parser.sub_pages.size * sizeof(html_item);
+        for (size_t i = 0; i < parser.middle_rows; i++)
+            parser_bytes += parser.middle[i].size * sizeof(html_item);
+        free_html_parser(&parser);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double parser_ns = elapsed_ns(start, end) / ROUNDS;
+
+    // The span view, reused between the pages like a batch job would
+    html_page_view view;
+    init_html_page_view(&view);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t round = 0; round < ROUNDS; round++) {
+        parse_html_page_view(&view, page.html, page.size);
+        rows += view.middle_rows;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double view_ns = elapsed_ns(start, end) / ROUNDS;
+    size_t view_bytes = sizeof(html_page_view) + view.middle_rows * sizeof(html_row_view)
+        + view.items_size * sizeof(html_item_view) + view.decoded_size;
+    free_html_page_view(&view);
+
+    printf("page view: %zu byte page, %d rounds (%zu rows)\n", page.size, ROUNDS, rows);
+    printf("  html_parser     %8.0f ns/page %8zu bytes/page\n", parser_ns, parser_bytes);
+    printf("  html_page_view  %8.0f ns/page %8zu bytes/page\n", view_ns, view_bytes);
+
+    free(page.html);
+    return 0;
+}
@@ -0,0 +1,152 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tekstitv.h>
+#include <time.h>
+
+#include "../lib/html_scan.h"
+
+#define PAGE_PATH "tests/test_html/100.htm"
+#define ROUNDS 2000
+
+static double elapsed_ns(struct timespec start, struct timespec end)
+{
+    return (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+}
+
+static void print_speed(const char* name, double total_ns, double total_bytes)
+{
+    printf("  %-24s %8.2f MB/s\n", name, total_bytes / (total_ns / 1e9) / (1024 * 1024));
+}
+
+// The byte by byte strncmp loop the parser used before html_scan
+static size_t naive_find_str(const char* data, size_t len, const char* str, size_t str_len)
+{
+    for (size_t i = 0; i + str_len <= len; i++) {
+        if (strncmp(data + i, str, str_len) == 0)
+            return i;
+    }
+    return len;
+}
+
+static size_t naive_find_char2(const char* data, size_t len, char a, char b)
+{
+    size_t i = 0;
+    while (i < len && data[i] != a && data[i] != b)
+        i++;
+    return i;
+}
+
+// Walk through the whole buffer one match at a time like the parser does
+static size_t count_chars(const html_scanner* scanner, const char* data, size_t len, char c)
+{
+    size_t count = 0;
+    for (size_t i = scanner->find_char(data, len, c); i < len; count++) {
+        i++;
+        i += scanner->find_char(data + i, len - i, c);
+    }
+    return count;
+}
+
+static size_t count_chars2(const char* data, size_t len, char a, char b,
+    size_t (*find)(const char*, size_t, char, char))
+{
+    size_t count = 0;
+    for (size_t i = find(data, len, a, b); i < len; count++) {
+        i++;
+        i += find(data + i, len - i, a, b);
+    }
+    return count;
+}
+
+static size_t count_strs(const char* data, size_t len, const char* str,
+    size_t (*find)(const char*, size_t, const char*, size_t))
+{
+    size_t str_len = strlen(str);
+    size_t count = 0;
+    for (size_t i = find(data, len, str, str_len); i < len; count++) {
+        i += str_len;
+        i += find(data + i, len - i, str, str_len);
+    }
+    return count;
+}
+
+int main(void)
+{
+    FILE* fp = fopen(PAGE_PATH, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "Cannot open %s\n", PAGE_PATH);
+        return 1;
+    }
+
+    html_buffer page = { 0 };
+    page.limit = HTML_BUFFER_DEFAULT_LIMIT;
+    char chunk[4096];
+    size_t read;
+    while ((read = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+        html_buffer_append(&page, chunk, read);
+    fclose(fp);
+
+    const html_scanner* scanners[8];
+    size_t scanner_count = html_scan_supported(scanners, 8);
+    double total_bytes = (double)page.size * ROUNDS;
+    struct timespec start, end;
+    size_t found = 0;
+
+    printf("html scanning: %zu byte page, %d rounds, using %s\n", page.size, ROUNDS, html_scan.name);
+
+    printf(" find '<' or '\\r'\n");
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t round = 0; round < ROUNDS; round++)
+        found += count_chars2(page.html, page.size, '<', '\r', naive_find_char2);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    print_speed("naive", elapsed_ns(start, end), total_bytes);
+    for (size_t s = 0; s < scanner_count; s++) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (size_t round = 0; round < ROUNDS; round++)
+            found += count_chars2(page.html, page.size, '<', '\r', scanners[s]->find_char2);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        print_speed(scanners[s]->name, elapsed_ns(start, end), total_bytes);
+    }
+
+    printf(" find '>'\n");
+    for (size_t s = 0; s < scanner_count; s++) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (size_t round = 0; round < ROUNDS; round++)
+            found += count_chars(scanners[s], page.html, page.size, '>');
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        print_speed(scanners[s]->name, elapsed_ns(start, end), total_bytes);
+    }
+
+    printf(" find \"</pre>\"\n");
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t round = 0; round < ROUNDS; round++)
+        found += count_strs(page.html, page.size, "</pre>", naive_find_str);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    print_speed("naive", elapsed_ns(start, end), total_bytes);
+    for (size_t s = 0; s < scanner_count; s++) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (size_t round = 0; round < ROUNDS; round++)
+            found += count_strs(page.html, page.size, "</pre>", scanners[s]->find_str);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        print_speed(scanners[s]->name, elapsed_ns(start, end), total_bytes);
+    }
+
+    printf(" parse_html\n");
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t round = 0; round < ROUNDS; round++) {
+        html_parser parser;
+        init_html_parser(&parser);
+        html_buffer_append(&parser._curl_buffer, page.html, page.size);
+        parse_html(&parser);
+        found += parser.middle_rows;
+        free_html_parser(&parser);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    print_speed(html_scan.name, elapsed_ns(start, end), total_bytes);
+    printf(" (%zu matches)\n", found);
+
+    free(page.html);
+    return 0;
+}
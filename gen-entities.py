@@ -0,0 +1,368 @@
+#!/usr/bin/env python3
+#
+# Generate lib/html_entities.h
+#
+# The html entities that can be found in yle tekstitv pages are listed here
+# with their unicode code point and the ascii replacement that is used when
+# the library is built with --disable-utf8.
+#
+# Entities are looked up with a two level perfect hash so the parser can
+# decode an entity with a single table probe, no matter how many entities
+# are supported. To add a new entity, add it to ENTITIES and rerun:
+#
+#   ./gen-entities.py > lib/html_entities.h
+
+import sys
+
+# (entity without '&' and ';', code point, ascii replacement, description)
+ENTITIES = [
+    ("#256", 0x0100, "A", "LATIN CAPITAL LETTER A WITH MACRON"),
+    ("#257", 0x0101, "a", "LATIN SMALL LETTER A WITH MACRON"),
+    ("#260", 0x0104, "A", "LATIN CAPITAL LETTER A WITH OGONEK"),
+    ("#261", 0x0105, "a", "LATIN SMALL LETTER A WITH OGONEK"),
+    ("#263", 0x0107, "c", "LATIN SMALL LETTER C WITH ACUTE"),
+    ("#264", 0x0108, "C", "LATIN CAPITAL LETTER C WITH CIRCUMFLEX"),
+    ("#265", 0x0109, "c", "LATIN SMALL LETTER C WITH CIRCUMFLEX"),
+    ("#266", 0x010a, "C", "LATIN CAPITAL LETTER C WITH DOT ABOVE"),
+    ("#267", 0x010b, "c", "LATIN SMALL LETTER C WITH DOT ABOVE"),
+    ("#268", 0x010c, "C", "LATIN CAPITAL LETTER C WITH CARON"),
+    ("#269", 0x010d, "c", "LATIN SMALL LETTER C WITH CARON"),
+    ("#270", 0x010e, "D", "LATIN CAPITAL LETTER D WITH CARON"),
+    ("#271", 0x010f, "d", "LATIN SMALL LETTER D WITH CARON"),
+    ("#273", 0x0111, "d", "LATIN SMALL LETTER D WITH STROKE"),
+    ("#274", 0x0112, "E", "LATIN CAPITAL LETTER E WITH MACRON"),
+    ("#275", 0x0113, "e", "LATIN SMALL LETTER E WITH MACRON"),
+    ("#278", 0x0116, "E", "LATIN CAPITAL LETTER E WITH DOT ABOVE"),
+    ("#279", 0x0117, "e", "LATIN SMALL LETTER E WITH DOT ABOVE"),
+    ("#280", 0x0118, "E", "LATIN CAPITAL LETTER E WITH OGONEK"),
+    ("#281", 0x0119, "e", "LATIN SMALL LETTER E WITH OGONEK"),
+    ("#282", 0x011a, "E", "LATIN CAPITAL LETTER E WITH CARON"),
+    ("#283", 0x011b, "e", "LATIN SMALL LETTER E WITH CARON"),
+    ("#284", 0x011c, "G", "LATIN CAPITAL LETTER G WITH CIRCUMFLEX"),
+    ("#285", 0x011d, "g", "LATIN SMALL LETTER G WITH CIRCUMFLEX"),
+    ("#286", 0x011e, "G", "LATIN CAPITAL LETTER G WITH BREVE"),
+    ("#287", 0x011f, "g", "LATIN SMALL LETTER G WITH BREVE"),
+    ("#288", 0x0120, "G", "LATIN CAPITAL LETTER G WITH DOT ABOVE"),
+    ("#289", 0x0121, "g", "LATIN SMALL LETTER G WITH DOT ABOVE"),
+    ("#290", 0x0122, "K", "LATIN CAPITAL LETTER K WITH CEDILLA"),
+    ("#291", 0x0123, "k", "LATIN SMALL LETTER K WITH CEDILLA"),
+    ("#292", 0x0124, "H", "LATIN CAPITAL LETTER H WITH CIRCUMFLEX"),
+    ("#293", 0x0125, "h", "LATIN SMALL LETTER H WITH CIRCUMFLEX"),
+    ("#294", 0x0126, "H", "LATIN CAPITAL LETTER H WITH STROKE"),
+    ("#295", 0x0127, "h", "LATIN SMALL LETTER H WITH STROKE"),
+    ("#296", 0x0128, "I", "LATIN CAPITAL LETTER I WITH TILDE"),
+    ("#297", 0x0129, "i", "LATIN SMALL LETTER I WITH TILDE"),
+    ("#298", 0x012a, "I", "LATIN CAPITAL LETTER I WITH MACRON"),
+    ("#299", 0x012b, "i", "LATIN SMALL LETTER I WITH MACRON"),
+    ("#302", 0x012e, "I", "LATIN CAPITAL LETTER I WITH OGONEK"),
+    ("#303", 0x012f, "i", "LATIN SMALL LETTER I WITH OGONEK"),
+    ("#304", 0x0130, "I", "LATIN CAPITAL LETTER I WITH DOT ABOVE"),
+    ("#305", 0x0131, "i", "LATIN SMALL LETTER DOTLESS I"),
+    ("#308", 0x0134, "J", "LATIN CAPITAL LETTER J WITH CIRCUMFLEX"),
+    ("#309", 0x0135, "j", "LATIN SMALL LETTER J WITH CIRCUMFLEX"),
+    ("#310", 0x0136, "L", "LATIN CAPITAL LETTER L WITH CEDILLA"),
+    ("#311", 0x0137, "l", "LATIN SMALL LETTER L WITH CEDILLA"),
+    ("#312", 0x0138, "K", "LATIN SMALL LETTER KRA"),
+    ("#313", 0x0139, "L", "LATIN CAPITAL LETTER L WITH ACUTE"),
+    ("#314", 0x013a, "l", "LATIN SMALL LETTER L WITH ACUTE"),
+    ("#315", 0x013b, "L", "LATIN CAPITAL LETTER L WITH CEDILLA"),
+    ("#316", 0x013c, "l", "LATIN SMALL LETTER L WITH CEDILLA"),
+    ("#317", 0x013d, "L", "LATIN CAPITAL LETTER L WITH CARON"),
+    ("#318", 0x013e, "l", "LATIN SMALL LETTER L WITH CARON"),
+    ("#319", 0x013f, "L", "LATIN CAPITAL LETTER L WITH MIDDLE DOT"),
+    ("#320", 0x0140, "l", "LATIN SMALL LETTER L WITH MIDDLE DOT"),
+    ("#321", 0x0141, "L", "LATIN CAPITAL LETTER L WITH STROKE"),
+    ("#322", 0x0142, "l", "LATIN SMALL LETTER L WITH STROKE"),
+    ("#323", 0x0143, "L", "LATIN CAPITAL LETTER L WITH ACUTE"),
+    ("#324", 0x0144, "l", "LATIN SMALL LETTER L WITH ACUTE"),
+    ("#325", 0x0145, "N", "LATIN CAPITAL LETTER N WITH CEDILLA"),
+    ("#326", 0x0146, "n", "LATIN SMALL LETTER N WITH CEDILLA"),
+    ("#327", 0x0147, "N", "LATIN CAPITAL LETTER N WITH ACUTE"),
+    ("#328", 0x0148, "n", "LATIN SMALL LETTER N WITH ACUTE"),
+    ("#330", 0x014a, "N", "LATIN CAPITAL LETTER ENG"),
+    ("#331", 0x014b, "n", "LATIN SMALL LETTER ENG"),
+    ("#332", 0x014c, "O", "LATIN CAPITAL O LETTER WITH MACRON"),
+    ("#333", 0x014d, "o", "LATIN SMALL O LETTER WITH MACRON"),
+    ("#336", 0x0150, "O", "LATIN CAPITAL LETTER O WITH DOUBLE ACUTE"),
+    ("#337", 0x0151, "o", "LATIN SMALL LETTER O WITH DOUBLE ACUTE"),
+    ("#342", 0x0156, "R", "LATIN CAPITAL LETTER R WITH CEDILLA"),
+    ("#343", 0x0157, "r", "LATIN SMALL LETTER R WITH CEDILLA"),
+    ("#344", 0x0158, "R", "LATIN CAPITAL LETTER R WITH CARON"),
+    ("#345", 0x0159, "r", "LATIN SMALL LETTER R WITH CARON"),
+    ("#346", 0x015a, "S", "LATIN CAPITAL LETTER S WITH ACUTE"),
+    ("#347", 0x015b, "s", "LATIN SMALL LETTER S WITH ACUTE"),
+    ("#348", 0x015c, "S", "LATIN CAPITAL LETTER S WITH CIRCUMFLEX"),
+    ("#349", 0x015d, "s", "LATIN SMALL LETTER S WITH CIRCUMFLEX"),
+    ("#350", 0x015e, "S", "LATIN CAPITAL LETTER S WITH CEDILLA"),
+    ("#351", 0x015f, "s", "LATIN SMALL LETTER S WITH CEDILLA"),
+    ("#356", 0x0164, "T", "LATIN CAPITAL LETTER T WITH CARON"),
+    ("#357", 0x0165, "t", "LATIN SMALL LETTER T WITH CARON"),
+    ("#358", 0x0166, "T", "LATIN CAPITAL LETTER T WITH STROKE"),
+    ("#359", 0x0167, "t", "LATIN SMALL LETTER T WITH STROKE"),
+    ("#360", 0x0168, "U", "LATIN CAPITAL LETTER U WITH TILDE"),
+    ("#361", 0x0169, "u", "LATIN SMALL LETTER U WITH TILDE"),
+    ("#362", 0x016a, "U", "LATIN CAPITAL LETTER U WITH MACRON"),
+    ("#363", 0x016b, "u", "LATIN SMALL LETTER U WITH MACRON"),
+    ("#364", 0x016c, "U", "LATIN CAPITAL LETTER U WITH BREVE"),
+    ("#365", 0x016d, "u", "LATIN SMALL LETTER U WITH BREVE"),
+    ("#366", 0x016e, "U", "LATIN CAPITAL LETTER U WITH RING ABOVE"),
+    ("#367", 0x016f, "u", "LATIN SMALL LETTER U WITH RING ABOVE"),
+    ("#368", 0x0170, "U", "LATIN CAPITAL LETTER U WITH DOUBLE ACUTE"),
+    ("#369", 0x0171, "u", "LATIN SMALL LETTER U WITH DOUBLE ACUTE"),
+    ("#370", 0x0172, "U", "LATIN CAPITAL LETTER U WITH OGONEK"),
+    ("#371", 0x0173, "u", "LATIN SMALL LETTER U WITH OGONEK"),
+    ("#372", 0x0174, "W", "LATIN CAPITAL LETTER W WITH CIRCUMFLEX"),
+    ("#373", 0x0175, "w", "LATIN SMALL LETTER W WITH CIRCUMFLEX"),
+    ("#374", 0x0176, "Y", "LATIN CAPITAL LETTER Y WITH CIRCUMFLEX"),
+    ("#375", 0x0177, "y", "LATIN SMALL LETTER Y WITH CIRCUMFLEX"),
+    ("#377", 0x0179, "Z", "LATIN CAPITAL LETTER Z WITH ACUTE"),
+    ("#378", 0x017a, "z", "LATIN SMALL LETTER Z WITH ACUTE"),
+    ("#379", 0x017b, "Z", "LATIN CAPITAL LETTER Z WITH DOT ABOVE"),
+    ("#380", 0x017c, "z", "LATIN SMALL LETTER Z WITH DOT ABOVE"),
+    ("#381", 0x017d, "Z", "LATIN CAPITAL LETTER Z WITH CARON"),
+    ("#382", 0x017e, "z", "LATIN SMALL LETTER Z WITH CARON"),
+    ("#538", 0x021a, "T", "LATIN CAPITAL LETTER T WITH COMMA BELOW"),
+    ("#539", 0x021b, "t", "LATIN SMALL LETTER T WITH COMMA BELOW"),
+    ("#552", 0x0228, "E", "LATIN CAPITAL LETTER E WITH CEDILLA"),
+    ("#553", 0x0229, "e", "LATIN SMALL LETTER E WITH CEDILLA"),
+    ("#9834", 0x266a, "", "EIGHTH NOTE"),
+    ("#8486", 0x2126, "O", "OHM SIGN"),
+    ("#9608", 0x2588, " ", "FULL BLOCK"),
+    ("auml", 0x00e4, "a", "LATIN SMALL LETTER A WITH DIAERESIS"),
+    ("atilde", 0x00e3, "a", "LATIN SMALL LETTER A WITH TILDE"),
+    ("aring", 0x00e5, "a", "LATIN SMALL LETTER A WITH RING ABOVE"),
+    ("amp", 0x0026, "&", "AMPERSAND"),
+    ("apos", 0x0027, "'", "APOSTROPHE"),
+    ("alpha", 0x0251, "a", "LATIN SMALL LETTER ALPHA"),
+    ("aelig", 0x00e6, "a", "LATIN SMALL LETTER AE"),
+    ("aacute", 0x00e1, "a", "LATIN SMALL LETTER A WITH ACUTE"),
+    ("agrave", 0x00e0, "a", "LATIN SMALL LETTER A WITH GRAVE"),
+    ("acirc", 0x00e2, "a", "LATIN SMALL LETTER A WITH CIRCUMFLEX"),
+    ("Auml", 0x00c4, "A", "LATIN CAPITAL LETTER A WITH DIAERESIS"),
+    ("Atilde", 0x00c3, "A", "LATIN CAPITAL LETTER A WITH TILDE"),
+    ("Aring", 0x00c5, "A", "LATIN CAPITAL LETTER A WITH RING ABOVE"),
+    ("AElig", 0x00c6, "A", "LATIN CAPITAL LETTER AE"),
+    ("Aacute", 0x00c1, "A", "LATIN CAPITAL LETTER A WITH ACUTE"),
+    ("Agrave", 0x00c0, "A", "LATIN CAPITAL LETTER A WITH GRAVE"),
+    ("Acirc", 0x00c2, "A", "LATIN CAPITAL LETTER A WITH CIRCUMFLEX"),
+    ("curren", 0x00a4, "c", "CURRENCY SIGN"),
+    ("copy", 0x00a9, "c", "COPYRIGHT SIGN"),
+    ("ccedil", 0x00e7, "c", "LATIN SMALL LETTER C WITH CEDILLA"),
+    ("Ccedil", 0x00c7, "C", "LATIN CAPITAL LETTER C WITH CEDILLA"),
+    ("deg", 0x00b0, "o", "DEGREE SIGN"),
+    ("darr", 0x2193, "Y", "DOWNWARDS ARROW"),
+    ("eacute", 0x00e9, "e", "LATIN SMALL LETTER E WITH ACUTE"),
+    ("euro", 0x20ac, "e", "EURO SIGN"),
+    ("eth", 0x00f0, "e", "LATIN SMALL LETTER ETH"),
+    ("egrave", 0x00e8, "e", "LATIN SMALL LETTER E WITH GRAVE"),
+    ("euml", 0x00eb, "e", "LATIN SMALL LETTER E WITH DIAERESIS"),
+    ("ecirc", 0x00ea, "e", "LATIN SMALL LETTER E WITH CIRCUMFLEX"),
+    ("Eacute", 0x00c9, "E", "LATIN CAPITAL LETTER E WITH ACUTE"),
+    ("ETH", 0x00d0, "E", "LATIN CAPITAL LETTER ETH"),
+    ("Egrave", 0x00c8, "E", "LATIN CAPITAL LETTER E WITH GRAVE"),
+    ("Euml", 0x00cb, "E", "LATIN CAPITAL LETTER E WITH DIAERESIS"),
+    ("Ecirc", 0x00ca, "E", "LATIN CAPITAL LETTER E WITH CIRCUMFLEX"),
+    ("frac12", 0x00bd, "1/2", "VULGAR FRACTION ONE HALF"),
+    ("gt", 0x003e, ">", "GREATER-THAN SIGN"),
+    ("iexcl", 0x00a1, "!", "INVERTED EXCLAMATION MARK"),
+    ("iquest", 0x00bf, "?", "INVERTED QUESTION MARK"),
+    ("iacute", 0x00ed, "i", "LATIN SMALL LETTER I WITH ACUTE"),
+    ("igrave", 0x00ec, "i", "LATIN SMALL LETTER I WITH GRAVE"),
+    ("iuml", 0x00ef, "i", "LATIN SMALL LETTER I WITH DIAERESIS"),
+    ("icirc", 0x00ee, "i", "LATIN SMALL LETTER I WITH CIRCUMFLEX"),
+    ("Iacute", 0x00cd, "I", "LATIN CAPITAL LETTER I WITH ACUTE"),
+    ("Igrave", 0x00cc, "I", "LATIN CAPITAL LETTER I WITH GRAVE"),
+    ("Iuml", 0x00cf, "I", "LATIN CAPITAL LETTER I WITH DIAERESIS"),
+    ("Icirc", 0x00ce, "I", "LATIN CAPITAL LETTER I WITH CIRCUMFLEX"),
+    ("lt", 0x003c, "<", "LESS-THAN SIGN"),
+    ("laquo", 0x00ab, "<", "LEFT-POINTING DOUBLE ANGLE QUOTATION MARK"),
+    ("larr", 0x2190, "<", "LEFTWARDS ARROW"),
+    ("middot", 0x00b7, ".", "MIDDLE DOT"),
+    ("ndash", 0x2013, "-", "EN DASH"),
+    ("ntilde", 0x00f1, "n", "LATIN SMALL LETTER N WITH TILDE"),
+    ("Ntilde", 0x00d1, "N", "LATIN CAPITAL LETTER N WITH TILDE"),
+    ("ouml", 0x00f6, "o", "LATIN SMALL LETTER O WITH DIAERESIS"),
+    ("oslash", 0x00f8, "o", "LATIN SMALL LETTER O WITH STROKE"),
+    ("oelig", 0x0153, "oe", "LATIN SMALL LIGATURE OE"),
+    ("oacute", 0x00f3, "o", "LATIN SMALL LETTER O WITH ACUTE"),
+    ("ograve", 0x00f2, "o", "LATIN SMALL LETTER O WITH GRAVE"),
+    ("otilde", 0x00f5, "o", "LATIN SMALL LETTER O WITH TILDE"),
+    ("ocirc", 0x00f4, "o", "LATIN SMALL LETTER O WITH CIRCUMFLEX"),
+    ("Ouml", 0x00d6, "O", "LATIN CAPITAL LETTER O WITH DIAERESIS"),
+    ("Oslash", 0x00d8, "O", "LATIN CAPITAL LETTER O WITH STROKE"),
+    ("OElig", 0x0152, "OE", "LATIN CAPITAL LIGATURE OE"),
+    ("Oacute", 0x00d3, "O", "LATIN CAPITAL LETTER O WITH ACUTE"),
+    ("Ograve", 0x00d2, "O", "LATIN CAPITAL LETTER O WITH GRAVE"),
+    ("Otilde", 0x00d5, "O", "LATIN CAPITAL LETTER O WITH TILDE"),
+    ("Ocirc", 0x00d4, "O", "LATIN CAPITAL LETTER O WITH CIRCUMFLEX"),
+    ("pound", 0x00a3, "p", "POUND SIGN"),
+    ("plusmn", 0x00b1, "+/-", "PLUS-MINUS SIGN"),
+    ("permil", 0x2030, "p", "PER MILLE SIGN"),
+    ("quot", 0x0022, "\"", "QUOTATION MARK"),
+    ("raquo", 0x00bb, ">", "RIGHT-POINTING DOUBLE ANGLE QUOTATION MARK"),
+    ("rarr", 0x2192, ">", "RIGHTWARDS ARROW"),
+    ("rdquo", 0x201d, "\"", "RIGHT DOUBLE QUOTATION MARK"),
+    ("sect", 0x00a7, "s", "SECTION SIGN"),
+    ("szlig", 0x00df, "B", "LATIN SMALL LETTER SHARP S"),
+    ("scaron", 0x0161, "s", "LATIN SMALL LETTER S WITH CARON"),
+    ("sup1", 0x00b9, "1", "SUPERSCRIPT ONE"),
+    ("sup2", 0x00b2, "2", "SUPERSCRIPT TWO"),
+    ("sup3", 0x00b3, "3", "SUPERSCRIPT THREE"),
+    ("Scaron", 0x0160, "S", "LATIN CAPITAL LETTER S WITH CARON"),
+    ("thorn", 0x00fe, "t", "LATIN SMALL LETTER THORN"),
+    ("THORN", 0x00de, "T", "LATIN CAPITAL LETTER THORN"),
+    ("uuml", 0x00fc, "u", "LATIN SMALL LETTER U WITH DIAERESIS"),
+    ("uarr", 0x2191, "^", "UPWARDS ARROW"),
+    ("uacute", 0x00fa, "u", "LATIN SMALL LETTER U WITH ACUTE"),
+    ("ugrave", 0x00f9, "u", "LATIN SMALL LETTER U WITH GRAVE"),
+    ("ucirc", 0x00fb, "u", "LATIN SMALL LETTER U WITH CIRCUMFLEX"),
+    ("Uuml", 0x00dc, "U", "LATIN CAPITAL LETTER U WITH DIAERESIS"),
+    ("Uacute", 0x00da, "U", "LATIN CAPITAL LETTER U WITH ACUTE"),
+    ("Ugrave", 0x00d9, "U", "LATIN CAPITAL LETTER U WITH GRAVE"),
+    ("Ucirc", 0x00db, "U", "LATIN CAPITAL LETTER U WITH CIRCUMFLEX"),
+    ("yacute", 0x00fd, "y", "LATIN SMALL LETTER Y WITH ACUTE"),
+    ("yuml", 0x00ff, "y", "LATIN SMALL LETTER Y WITH DIAERESIS"),
+    ("Yacute", 0x00dd, "Y", "LATIN CAPITAL LETTER Y WITH ACUTE"),
+    ("Yuml", 0x0178, "Y", "LATIN CAPITAL LETTER Y WITH DIAERESIS"),
+    ("nbsp", 0x00a0, " ", "NO-BREAK SPACE"),
+]
+
+# Unicode code points that are not drawn as themselves
+UTF8_OVERRIDES = {
+    # Terminals don't need to know about non breaking spaces
+    "nbsp": " ",
+}
+
+BUCKETS = 64
+SLOTS = 256
+FNV_OFFSET = 2166136261
+FNV_PRIME = 16777619
+
+
+def entity_hash(seed, key):
+    value = FNV_OFFSET ^ seed
+    for c in key.encode("ascii"):
+        value = ((value ^ c) * FNV_PRIME) & 0xFFFFFFFF
+    return value
+
+
+def build_perfect_hash(keys):
+    buckets = [[] for _ in range(BUCKETS)]
+    for index, key in enumerate(keys):
+        buckets[entity_hash(0, key) % BUCKETS].append(index)
+
+    seeds = [0] * BUCKETS
+    slots = [0] * SLOTS
+    # Place the biggest buckets first while there is still room
+    for bucket in sorted(range(BUCKETS), key=lambda b: -len(buckets[b])):
+        if not buckets[bucket]:
+            continue
+        for seed in range(1, 0xFFFF):
+            taken = [entity_hash(seed, keys[i]) % SLOTS for i in buckets[bucket]]
+            if len(set(taken)) != len(taken):
+                continue
+            if any(slots[slot] != 0 for slot in taken):
+                continue
+            for slot, index in zip(taken, buckets[bucket]):
+                # 0 marks an empty slot so store the index + 1
+                slots[slot] = index + 1
+            seeds[bucket] = seed
+            break
+        else:
+            sys.exit("Couldn't find a perfect hash, increase SLOTS")
+
+    return seeds, slots
+
+
+def c_string(data):
+    out = ""
+    hex_escape = False
+    for byte in data:
+        char = chr(byte)
+        # Hex escapes don't have a length limit so split the string after them
+        if hex_escape and char in "0123456789abcdefABCDEF":
+            out += '" "'
+        hex_escape = False
+        if char == '"' or char == "\\":
+            out += "\\" + char
+        elif 0x20 <= byte < 0x7F:
+            out += char
+        else:
+            out += "\\x%02x" % byte
+            hex_escape = True
+    return '"' + out + '"'
+
+
+def c_array(values, per_line):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append("    " + ", ".join(str(v) for v in values[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def main():
+    keys = [entity[0] for entity in ENTITIES]
+    if len(set(keys)) != len(keys):
+        sys.exit("Duplicate entities found")
+
+    seeds, slots = build_perfect_hash(keys)
+
+    print("// Generated by gen-entities.py. Do not edit this file directly.")
+    print("#ifndef _HTML_ENTITIES_H_")
+    print("#define _HTML_ENTITIES_H_")
+    print()
+    print("#include <stddef.h>")
+    print("#include <stdint.h>")
+    print()
+    print("#define HTML_ENTITY_MAX_LEN %d" % max(len(key) for key in keys))
+    print("#define HTML_ENTITY_BUCKETS %d" % BUCKETS)
+    print("#define HTML_ENTITY_SLOTS %d" % SLOTS)
+    print()
+    print("typedef struct {")
+    print("    // Entity without the '&' and ';' characters")
+    print("    const char* name;")
+    print("    size_t name_len;")
+    print("    // Replacement used in utf-8 builds")
+    print("    const char* utf8;")
+    print("    size_t utf8_len;")
+    print("    // Replacement used when utf-8 is disabled")
+    print("    const char* ascii;")
+    print("    size_t ascii_len;")
+    print("} html_entity;")
+    print()
+    print("static const html_entity html_entities[] = {")
+    for name, code_point, ascii, description in ENTITIES:
+        utf8 = UTF8_OVERRIDES.get(name, chr(code_point)).encode("utf-8")
+        print("    // %s" % description)
+        print("    { %s, %d, %s, %d, %s, %d }," % (
+            c_string(name.encode("ascii")), len(name),
+            c_string(utf8), len(utf8),
+            c_string(ascii.encode("ascii")), len(ascii)))
+    print("};")
+    print()
+    print("static const uint16_t html_entity_seeds[HTML_ENTITY_BUCKETS] = {")
+    print(c_array(seeds, 12))
+    print("};")
+    print()
+    print("// Index + 1 to html_entities, 0 means that the slot is empty")
+    print("static const uint8_t html_entity_slots[HTML_ENTITY_SLOTS] = {")
+    print(c_array(slots, 16))
+    print("};")
+    print()
+    print("/**")
+    print(" * FNV-1a hash of the entity name. Seed 0 selects the bucket and the bucket's")
+    print(" * seed selects the final slot, which makes the lookup collision free.")
+    print(" */")
+    print("static inline uint32_t html_entity_hash(uint32_t seed, const char* name, size_t len)")
+    print("{")
+    print("    uint32_t hash = %du ^ seed;" % FNV_OFFSET)
+    print("    for (size_t i = 0; i < len; i++)")
+    print("        hash = (hash ^ (unsigned char)name[i]) * %du;" % FNV_PRIME)
+    print("    return hash;")
+    print("}")
+    print()
+    print("#endif")
+
+
+if __name__ == "__main__":
+    main()
@@ -8,12 +8,9 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #define HTML_TEXT_MAX 64
-// How many html_items can be on html_row
-#define HTML_ROW_MAX 16
-// How many html_rows the can be in the middle
-#define MIDDLE_HTML_ROWS_MAX 32
 #define TOP_NAVIGATION_SIZE 4
 #define BOTTOM_NAVIGATION_SIZE 6
 // The middle texts are always maximum of 39 characters
@@ -29,6 +26,8 @@ typedef enum {
 typedef struct {
     char text[HTML_TEXT_MAX];
     size_t size;
+    // Columns the text takes on the terminal, less than size with UTF-8 characters
+    size_t width;
 } html_text;
 
 typedef struct {
@@ -44,40 +43,222 @@ typedef struct {
     } item;
 } html_item;
 
+// Items are allocated from the parser's arena as they are parsed
 typedef struct {
-    html_item items[HTML_ROW_MAX];
+    html_item* items;
     size_t size;
 } html_row;
 
-typedef struct {
-    html_item* items;
-    size_t size;
-} html_dynamic_row;
+// Default hard limit for the size of a loaded page
+#define HTML_BUFFER_DEFAULT_LIMIT (1024 * 1024)
 
 typedef struct {
-    char html[1024 * 32];
+    // Grows when data is appended. NUL terminated when not NULL
+    char* html;
     size_t size;
+    size_t capacity;
     size_t current;
+    // Appending fails if the buffer would grow larger than this
+    size_t limit;
 } html_buffer;
 
+typedef struct html_arena_block html_arena_block;
+
+// Bump allocator for the memory of a single page
+typedef struct {
+    html_arena_block* first;
+    // Block the next allocation is tried from
+    html_arena_block* current;
+} html_arena;
+
+// Sections of the page in the order they are parsed
+typedef enum {
+    HTML_SECTION_NONE,
+    HTML_SECTION_TITLE,
+    HTML_SECTION_TOP_NAVIGATION,
+    HTML_SECTION_MIDDLE,
+    // Sub pages and bottom navigation are parsed once the whole page is loaded
+    HTML_SECTION_ALL,
+} html_section;
+
+// Sections the parser fills, the others are skipped without tokenizing them
+typedef enum {
+    HTML_PARSE_TITLE = 1 << 0,
+    HTML_PARSE_TOP_NAVIGATION = 1 << 1,
+    HTML_PARSE_MIDDLE = 1 << 2,
+    HTML_PARSE_SUB_PAGES = 1 << 3,
+    HTML_PARSE_BOTTOM_NAVIGATION = 1 << 4,
+    HTML_PARSE_ALL = (1 << 5) - 1,
+} html_parse_mask;
+
 typedef struct {
     // title seems to always be 1 string
     html_text title;
     html_item top_navigation[TOP_NAVIGATION_SIZE];
     html_link bottom_navigation[BOTTOM_NAVIGATION_SIZE];
-    html_dynamic_row sub_pages;
+    html_row sub_pages;
 
     // Middle part of the teksti tv seems to be only dynamic one
     html_row* middle;
     size_t middle_rows;
+    size_t _middle_capacity;
 
     html_buffer _curl_buffer;
+    // Owns the middle rows and the sub page items
+    html_arena _arena;
+    // Last section that is fully parsed
+    html_section parsed;
+    // html_parse_mask of the sections to parse. Defaults to HTML_PARSE_ALL
+    // and is kept when the parser is reset
+    unsigned sections;
     // Couldn't load the page
     bool curl_load_error;
+    // Network was unavailable so the page is an old copy from the disk cache
+    bool stale;
     // Buffer for the loadable shortlink
     char link[HTML_LINK_SIZE + 1];
 } html_parser;
 
+// Text of the page that is not copied out of the page html.
+// Texts that contain html entities are decoded to the view's side buffer.
+typedef struct {
+    uint32_t offset;
+    uint32_t size;
+    // offset is to html_page_view.decoded instead of the page html
+    bool decoded;
+} html_span;
+
+typedef struct {
+    html_item_type type;
+    // How many spaces are drawn before the text
+    uint32_t pre_space;
+    html_span text;
+    // Only set for HTML_LINK items
+    html_span url;
+} html_item_view;
+
+// Range of items in html_page_view.items
+typedef struct {
+    uint32_t first;
+    uint32_t size;
+} html_row_view;
+
+/**
+ * Read only alternative to html_parser that doesn't copy the texts.
+ * The html given to parse_html_page_view is not copied either, so it
+ * has to be kept alive and unchanged as long as the view is used.
+ * Parsing a new page reuses the memory of the previous one.
+ */
+typedef struct {
+    const char* html;
+    size_t html_size;
+    // Page doesn't exist
+    bool invalid;
+
+    html_span title;
+    html_item_view top_navigation[TOP_NAVIGATION_SIZE];
+    html_item_view bottom_navigation[BOTTOM_NAVIGATION_SIZE];
+    html_row_view sub_pages;
+    html_row_view* middle;
+    size_t middle_rows;
+    size_t middle_capacity;
+
+    // Items of the middle rows and the sub pages
+    html_item_view* items;
+    size_t items_size;
+    size_t items_capacity;
+
+    // Texts with their html entities decoded
+    char* decoded;
+    size_t decoded_size;
+    size_t decoded_capacity;
+} html_page_view;
+
+/**
+ * Parsers that are reused between the page loads. Taking a parser
+ * only allocates when all the parsers of the pool are in use.
+ * The pool is not thread safe.
+ */
+typedef struct {
+    // Parsers that are not in use
+    html_parser** parsers;
+    size_t size;
+    size_t capacity;
+} html_parser_pool;
+
+// Longest path for the disk cache directory
+#define PAGE_LOADER_PATH_MAX 4096
+
+// Called during the page load every time a new section of the page is parsed
+typedef void (*page_progress_callback)(html_parser* parser, void* data);
+
+// Pages are loaded from the base url followed by the link
+#define PAGE_LOADER_DEFAULT_BASE_URL "https://yle.fi/tekstitv/txt/"
+// Longest base url
+#define PAGE_LOADER_URL_MAX 1024
+
+// Loads pages without curl, for example from memory in tests and benchmarks.
+// Appends the page of the link to the buffer and returns false if there is no such page.
+// Can be called from several threads at the same time.
+typedef bool (*page_fetch_callback)(const char* link, html_buffer* buffer, void* data);
+
+typedef struct {
+    // Short link of the page, like 100_0001.htm
+    const char* link;
+    const char* html;
+    size_t size;
+} page_memory_entry;
+
+// In-memory pages for page_memory_fetch
+typedef struct {
+    const page_memory_entry* pages;
+    size_t size;
+    // Every load waits this long first to simulate the network
+    unsigned latency_ms;
+} page_memory_map;
+
+// Page loader owns the network state and should not be copied.
+typedef struct {
+    // CURL easy handle that is reused between the page loads, so the
+    // connection to yle.fi is kept alive between the pages
+    void* _curl;
+    // Error message of the latest failed load. Same size as CURL_ERROR_SIZE
+    char error[256];
+    // Non zero aborts the running load. Other threads change it with
+    // loader_set_cancel, so it's only accessed atomically
+    int cancel;
+    // Directory of the on-disk page cache. Empty when the cache is disabled
+    char cache_dir[PAGE_LOADER_PATH_MAX];
+    // Optional callback for drawing the page before it's fully loaded
+    page_progress_callback on_progress;
+    void* progress_data;
+    // Pages larger than this fail to load. Defaults to HTML_BUFFER_DEFAULT_LIMIT
+    size_t max_page_size;
+    // Any url curl supports, like file:///path/to/pages/ or http://localhost:8080/
+    char base_url[PAGE_LOADER_URL_MAX];
+    // Replaces curl and the disk cache when set
+    page_fetch_callback fetch;
+    void* fetch_data;
+} page_loader;
+
+// Default limits for load_page_batch
+#define PAGE_BATCH_MAX_CONCURRENCY 16
+#define PAGE_BATCH_MAX_HOST_CONNECTIONS 8
+
+typedef struct {
+    // How many transfers can run at the same time. 0 uses the default
+    long max_concurrency;
+    // How many connections can be open to a single host. 0 uses the default
+    long max_host_connections;
+    // Largest page that can be loaded. 0 uses HTML_BUFFER_DEFAULT_LIMIT
+    size_t max_page_size;
+    // NULL uses PAGE_LOADER_DEFAULT_BASE_URL
+    const char* base_url;
+    // Loads the pages one by one instead of curl when set
+    page_fetch_callback fetch;
+    void* fetch_data;
+} page_batch_options;
+
 #define html_item_as_text(_item) ((_item).item.text)
 #define html_item_as_link(_item) ((_item).item.link)
 
@@ -86,13 +267,32 @@ typedef struct {
 #define html_link_text_size(_link) ((_link).inner_text.size)
 #define html_text_text(_text) ((_text).text)
 #define html_text_text_size(_text) ((_text).size)
+#define html_link_text_width(_link) ((_link).inner_text.width)
+#define html_text_text_width(_text) ((_text).width)
 
 void init_html_parser(html_parser* parser);
 void free_html_parser(html_parser* parser);
+void reset_html_parser(html_parser* parser);
+bool copy_html_parser(html_parser* target, const html_parser* source);
+size_t html_parser_memory(const html_parser* parser);
 void parse_html(html_parser* parser);
+bool parse_html_partial(html_parser* parser, bool finished);
+void parse_html_buffer(html_parser* parser, const char* html, size_t size);
+bool parse_html_file(html_parser* parser, const char* path);
+bool html_buffer_append(html_buffer* buffer, const char* data, size_t len);
 void link_from_ints(html_parser* parser, int page, int subpage);
 void link_from_short_link(html_parser* parser, char* shortlink);
 
+void init_html_parser_pool(html_parser_pool* pool);
+void free_html_parser_pool(html_parser_pool* pool);
+html_parser* html_parser_pool_take(html_parser_pool* pool);
+void html_parser_pool_give(html_parser_pool* pool, html_parser* parser);
+
+void init_html_page_view(html_page_view* view);
+void free_html_page_view(html_page_view* view);
+bool parse_html_page_view(html_page_view* view, const char* html, size_t size);
+
+size_t utf8_text_width(const char* text, size_t size);
 int page_number(const char* page);
 int subpage_number(const char* subpage);
 
@@ -108,6 +308,46 @@ static inline size_t html_item_text_size(html_item item)
     }
 }
 
+static inline size_t html_item_text_width(html_item item)
+{
+    switch (item.type) {
+    case HTML_TEXT:
+        return html_text_text_width(html_item_as_text(item));
+    case HTML_LINK:
+        return html_link_text_width(html_item_as_link(item));
+    default:
+        return 0;
+    }
+}
+
+// The span's text is not NUL terminated
+static inline const char* html_span_text(const html_page_view* view, html_span span)
+{
+    return (span.decoded ? view->decoded : view->html) + span.offset;
+}
+
+static inline const html_item_view* html_row_view_items(const html_page_view* view, html_row_view row)
+{
+    return view->items + row.first;
+}
+
+/**
+ * Set up the process wide state of libcurl. Call it once before the threads
+ * that create page loaders are started, everything else in the library keeps
+ * its state in the objects given to it.
+ */
+bool init_tekstitv(void);
+void free_tekstitv(void);
+
+void init_page_loader(page_loader* loader);
+void free_page_loader(page_loader* loader);
+bool loader_use_disk_cache(page_loader* loader, const char* dir);
+bool loader_set_base_url(page_loader* loader, const char* url);
+void loader_use_fetch(page_loader* loader, page_fetch_callback fetch, void* data);
+void loader_set_cancel(page_loader* loader, bool cancel);
+bool page_memory_fetch(const char* link, html_buffer* buffer, void* data);
+void loader_load_page(page_loader* loader, html_parser* parser);
 void load_page(html_parser* parser);
+void load_page_batch(page_batch_options options, char** links, html_parser* parsers, size_t count);
 
 #endif
@@ -0,0 +1,194 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "disk_cache.h"
+
+/*
+ * Every page is stored in its own file named by the short link:
+ *
+ *   ETag: <etag>
+ *   Last-Modified: <date>
+ *
+ *   <page html>
+ *
+ * Files are written to a temporary file first and renamed over
+ * the old one, so readers never see a partially written page.
+ */
+
+/**
+ * Links come from the hrefs of the pages, only links like 100_0001.htm
+ * are used as file names so they can't point outside the directory
+ */
+static bool is_page_link(const char* link)
+{
+    for (size_t i = 0; i < 8; i++) {
+        bool digit = link[i] >= '0' && link[i] <= '9';
+        if (i == 3 ? link[i] != '_' : !digit)
+            return false;
+    }
+
+    return memcmp(link + 8, ".htm", 4) == 0;
+}
+
+static bool cache_path(char* path, size_t size, const char* dir, const char* link)
+{
+    if (!is_page_link(link))
+        return false;
+
+    int len = snprintf(path, size, "%s/%.*s", dir, HTML_LINK_SIZE, link);
+    return len > 0 && (size_t)len < size;
+}
+
+static void read_header_value(const char* line, const char* name, char* value)
+{
+    size_t name_len = strlen(name);
+    if (strncmp(line, name, name_len) != 0)
+        return;
+
+    size_t len = strcspn(line + name_len, "\n");
+    if (len >= DISK_CACHE_VALIDATOR_MAX)
+        len = DISK_CACHE_VALIDATOR_MAX - 1;
+    memcpy(value, line + name_len, len);
+    value[len] = '\0';
+}
+
+/**
+ * Read the headers of the cache file. File is left at the start of the page.
+ */
+static bool read_cache_headers(FILE* file, cache_validators* validators)
+{
+    char line[DISK_CACHE_VALIDATOR_MAX + 32];
+    validators->etag[0] = '\0';
+    validators->last_modified[0] = '\0';
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (line[0] == '\n')
+            return true;
+
+        read_header_value(line, "ETag: ", validators->etag);
+        read_header_value(line, "Last-Modified: ", validators->last_modified);
+    }
+
+    // Missing the empty line before the page
+    return false;
+}
+
+/**
+ * $XDG_CACHE_HOME/tekstitv or ~/.cache/tekstitv
+ */
+bool disk_cache_default_dir(char* dir, size_t size)
+{
+    const char* xdg_cache = getenv("XDG_CACHE_HOME");
+    const char* home = getenv("HOME");
+    int len;
+
+    if (xdg_cache != NULL && xdg_cache[0] != '\0')
+        len = snprintf(dir, size, "%s/tekstitv", xdg_cache);
+    else if (home != NULL && home[0] != '\0')
+        len = snprintf(dir, size, "%s/.cache/tekstitv", home);
+    else
+        return false;
+
+    return len > 0 && (size_t)len < size;
+}
+
+/**
+ * Create the directory and its missing parents
+ */
+bool disk_cache_create_dir(const char* dir)
+{
+    char path[PAGE_LOADER_PATH_MAX];
+    size_t len = strlen(dir);
+    if (len == 0 || len >= sizeof(path))
+        return false;
+
+    memcpy(path, dir, len + 1);
+    for (size_t i = 1; i <= len; i++) {
+        if (path[i] != '/' && path[i] != '\0')
+            continue;
+
+        char c = path[i];
+        path[i] = '\0';
+        if (mkdir(path, 0700) != 0 && errno != EEXIST)
+            return false;
+        path[i] = c;
+    }
+
+    return true;
+}
+
+bool disk_cache_read_validators(const char* dir, const char* link, cache_validators* validators)
+{
+    char path[PAGE_LOADER_PATH_MAX];
+    if (!cache_path(path, sizeof(path), dir, link))
+        return false;
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+        return false;
+
+    bool success = read_cache_headers(file, validators);
+    fclose(file);
+    return success;
+}
+
+bool disk_cache_read_page(const char* dir, const char* link, html_buffer* buffer)
+{
+    char path[PAGE_LOADER_PATH_MAX];
+    cache_validators validators;
+    if (!cache_path(path, sizeof(path), dir, link))
+        return false;
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+        return false;
+
+    bool success = read_cache_headers(file, &validators);
+    buffer->size = 0;
+    buffer->current = 0;
+    while (success && !feof(file)) {
+        char chunk[1024 * 16];
+        size_t len = fread(chunk, 1, sizeof(chunk), file);
+        success = !ferror(file) && html_buffer_append(buffer, chunk, len);
+    }
+
+    fclose(file);
+    return success;
+}
+
+void disk_cache_write_page(const char* dir, const char* link, const cache_validators* validators, const html_buffer* buffer)
+{
+    char path[PAGE_LOADER_PATH_MAX];
+    char tmp_path[PAGE_LOADER_PATH_MAX];
+    if (!cache_path(path, sizeof(path), dir, link))
+        return;
+
+    int len = snprintf(tmp_path, sizeof(tmp_path), "%s.XXXXXX", path);
+    if (len < 0 || (size_t)len >= sizeof(tmp_path))
+        return;
+
+    int fd = mkstemp(tmp_path);
+    if (fd == -1)
+        return;
+
+    FILE* file = fdopen(fd, "wb");
+    if (file == NULL) {
+        close(fd);
+        unlink(tmp_path);
+        return;
+    }
+
+    fprintf(file, "ETag: %s\n", validators->etag);
+    fprintf(file, "Last-Modified: %s\n\n", validators->last_modified);
+    fwrite(buffer->html, 1, buffer->size, file);
+
+    bool failed = ferror(file);
+    if (fclose(file) != 0 || failed || rename(tmp_path, path) != 0)
+        unlink(tmp_path);
+}
@@ -0,0 +1,23 @@
+#ifndef _DISK_CACHE_H_
+#define _DISK_CACHE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <tekstitv.h>
+
+// Longest ETag or Last-Modified value that is stored
+#define DISK_CACHE_VALIDATOR_MAX 256
+
+// Response headers used to revalidate the cached page
+typedef struct {
+    char etag[DISK_CACHE_VALIDATOR_MAX];
+    char last_modified[DISK_CACHE_VALIDATOR_MAX];
+} cache_validators;
+
+bool disk_cache_default_dir(char* dir, size_t size);
+bool disk_cache_create_dir(const char* dir);
+bool disk_cache_read_validators(const char* dir, const char* link, cache_validators* validators);
+bool disk_cache_read_page(const char* dir, const char* link, html_buffer* buffer);
+void disk_cache_write_page(const char* dir, const char* link, const cache_validators* validators, const html_buffer* buffer);
+
+#endif
@@ -0,0 +1,127 @@
+#include <stdlib.h>
+#include <string.h>
+#include <tekstitv.h>
+
+#include "html_arena.h"
+
+// Everything allocated from the arena is aligned to this
+#define HTML_ARENA_ALIGN 16
+
+struct html_arena_block {
+    html_arena_block* next;
+    size_t size;
+    size_t used;
+    // Offset of the latest allocation, so it can be grown in place
+    size_t last;
+    // The four fields above keep the data aligned
+    char data[];
+};
+
+static inline size_t align_size(size_t size)
+{
+    return (size + HTML_ARENA_ALIGN - 1) & ~(size_t)(HTML_ARENA_ALIGN - 1);
+}
+
+void init_html_arena(html_arena* arena)
+{
+    arena->first = NULL;
+    arena->current = NULL;
+}
+
+void free_html_arena(html_arena* arena)
+{
+    html_arena_block* block = arena->first;
+    while (block != NULL) {
+        html_arena_block* next = block->next;
+        free(block);
+        block = next;
+    }
+
+    init_html_arena(arena);
+}
+
+/**
+ * Forget everything allocated from the arena. The blocks are kept
+ * for the next page, and the ones after the first are only cleared
+ * when the allocations reach them.
+ */
+void html_arena_reset(html_arena* arena)
+{
+    arena->current = arena->first;
+    if (arena->first != NULL) {
+        arena->first->used = 0;
+        arena->first->last = 0;
+    }
+}
+
+void* html_arena_alloc(html_arena* arena, size_t size)
+{
+    size = align_size(size);
+
+    // Reuse the blocks from the previous pages before allocating new ones
+    html_arena_block* block = arena->current;
+    while (block != NULL && block->size - block->used < size) {
+        block = block->next;
+        if (block != NULL) {
+            block->used = 0;
+            block->last = 0;
+        }
+    }
+
+    if (block == NULL) {
+        size_t block_size = size > HTML_ARENA_BLOCK_SIZE ? size : HTML_ARENA_BLOCK_SIZE;
+        block = malloc(sizeof(html_arena_block) + block_size);
+        if (block == NULL)
+            return NULL;
+
+        block->size = block_size;
+        block->used = 0;
+        block->last = 0;
+
+        // The new block goes after the current one, so the old blocks
+        // that were too small are still used for the smaller allocations
+        if (arena->current == NULL) {
+            block->next = arena->first;
+            arena->first = block;
+        } else {
+            block->next = arena->current->next;
+            arena->current->next = block;
+        }
+    }
+
+    arena->current = block;
+    block->last = block->used;
+    block->used += size;
+    return block->data + block->last;
+}
+
+/**
+ * Resize an allocation. The latest allocation grows in place when
+ * the block has room for it, otherwise the data is copied.
+ */
+void* html_arena_grow(html_arena* arena, void* ptr, size_t old_size, size_t new_size)
+{
+    html_arena_block* block = arena->current;
+    if (ptr != NULL && block != NULL && ptr == block->data + block->last
+        && block->size - block->last >= align_size(new_size)) {
+        block->used = block->last + align_size(new_size);
+        return ptr;
+    }
+
+    void* grown = html_arena_alloc(arena, new_size);
+    if (grown != NULL && ptr != NULL)
+        memcpy(grown, ptr, old_size < new_size ? old_size : new_size);
+    return grown;
+}
+
+/**
+ * Bytes the arena has allocated from the system, used or not
+ */
+size_t html_arena_memory(const html_arena* arena)
+{
+    size_t memory = 0;
+    for (const html_arena_block* block = arena->first; block != NULL; block = block->next)
+        memory += sizeof(html_arena_block) + block->size;
+
+    return memory;
+}
@@ -0,0 +1,17 @@
+#ifndef _HTML_ARENA_H_
+#define _HTML_ARENA_H_
+
+#include <stddef.h>
+#include <tekstitv.h>
+
+// Smallest block the arena allocates from the system
+#define HTML_ARENA_BLOCK_SIZE (1024 * 16)
+
+void init_html_arena(html_arena* arena);
+void free_html_arena(html_arena* arena);
+void html_arena_reset(html_arena* arena);
+void* html_arena_alloc(html_arena* arena, size_t size);
+void* html_arena_grow(html_arena* arena, void* ptr, size_t old_size, size_t new_size);
+size_t html_arena_memory(const html_arena* arena);
+
+#endif
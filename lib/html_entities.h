@@ -0,0 +1,486 @@
+// Generated by gen-entities.py. Do not edit this file directly.
+#ifndef _HTML_ENTITIES_H_
+#define _HTML_ENTITIES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HTML_ENTITY_MAX_LEN 6
+#define HTML_ENTITY_BUCKETS 64
+#define HTML_ENTITY_SLOTS 256
+
+typedef struct {
+    // Entity without the '&' and ';' characters
+    const char* name;
+    size_t name_len;
+    // Replacement used in utf-8 builds
+    const char* utf8;
+    size_t utf8_len;
+    // Replacement used when utf-8 is disabled
+    const char* ascii;
+    size_t ascii_len;
+} html_entity;
+
+static const html_entity html_entities[] = {
+    // LATIN CAPITAL LETTER A WITH MACRON
+    { "#256", 4, "\xc4\x80", 2, "A", 1 },
+    // LATIN SMALL LETTER A WITH MACRON
+    { "#257", 4, "\xc4\x81", 2, "a", 1 },
+    // LATIN CAPITAL LETTER A WITH OGONEK
+    { "#260", 4, "\xc4\x84", 2, "A", 1 },
+    // LATIN SMALL LETTER A WITH OGONEK
+    { "#261", 4, "\xc4\x85", 2, "a", 1 },
+    // LATIN SMALL LETTER C WITH ACUTE
+    { "#263", 4, "\xc4\x87", 2, "c", 1 },
+    // LATIN CAPITAL LETTER C WITH CIRCUMFLEX
+    { "#264", 4, "\xc4\x88", 2, "C", 1 },
+    // LATIN SMALL LETTER C WITH CIRCUMFLEX
+    { "#265", 4, "\xc4\x89", 2, "c", 1 },
+    // LATIN CAPITAL LETTER C WITH DOT ABOVE
+    { "#266", 4, "\xc4\x8a", 2, "C", 1 },
+    // LATIN SMALL LETTER C WITH DOT ABOVE
+    { "#267", 4, "\xc4\x8b", 2, "c", 1 },
+    // LATIN CAPITAL LETTER C WITH CARON
+    { "#268", 4, "\xc4\x8c", 2, "C", 1 },
+    // LATIN SMALL LETTER C WITH CARON
+    { "#269", 4, "\xc4\x8d", 2, "c", 1 },
+    // LATIN CAPITAL LETTER D WITH CARON
+    { "#270", 4, "\xc4\x8e", 2, "D", 1 },
+    // LATIN SMALL LETTER D WITH CARON
+    { "#271", 4, "\xc4\x8f", 2, "d", 1 },
+    // LATIN SMALL LETTER D WITH STROKE
+    { "#273", 4, "\xc4\x91", 2, "d", 1 },
+    // LATIN CAPITAL LETTER E WITH MACRON
+    { "#274", 4, "\xc4\x92", 2, "E", 1 },
+    // LATIN SMALL LETTER E WITH MACRON
+    { "#275", 4, "\xc4\x93", 2, "e", 1 },
+    // LATIN CAPITAL LETTER E WITH DOT ABOVE
+    { "#278", 4, "\xc4\x96", 2, "E", 1 },
+    // LATIN SMALL LETTER E WITH DOT ABOVE
+    { "#279", 4, "\xc4\x97", 2, "e", 1 },
+    // LATIN CAPITAL LETTER E WITH OGONEK
+    { "#280", 4, "\xc4\x98", 2, "E", 1 },
+    // LATIN SMALL LETTER E WITH OGONEK
+    { "#281", 4, "\xc4\x99", 2, "e", 1 },
+    // LATIN CAPITAL LETTER E WITH CARON
+    { "#282", 4, "\xc4\x9a", 2, "E", 1 },
+    // LATIN SMALL LETTER E WITH CARON
+    { "#283", 4, "\xc4\x9b", 2, "e", 1 },
+    // LATIN CAPITAL LETTER G WITH CIRCUMFLEX
+    { "#284", 4, "\xc4\x9c", 2, "G", 1 },
+    // LATIN SMALL LETTER G WITH CIRCUMFLEX
+    { "#285", 4, "\xc4\x9d", 2, "g", 1 },
+    // LATIN CAPITAL LETTER G WITH BREVE
+    { "#286", 4, "\xc4\x9e", 2, "G", 1 },
+    // LATIN SMALL LETTER G WITH BREVE
+    { "#287", 4, "\xc4\x9f", 2, "g", 1 },
+    // LATIN CAPITAL LETTER G WITH DOT ABOVE
+    { "#288", 4, "\xc4\xa0", 2, "G", 1 },
+    // LATIN SMALL LETTER G WITH DOT ABOVE
+    { "#289", 4, "\xc4\xa1", 2, "g", 1 },
+    // LATIN CAPITAL LETTER K WITH CEDILLA
+    { "#290", 4, "\xc4\xa2", 2, "K", 1 },
+    // LATIN SMALL LETTER K WITH CEDILLA
+    { "#291", 4, "\xc4\xa3", 2, "k", 1 },
+    // LATIN CAPITAL LETTER H WITH CIRCUMFLEX
+    { "#292", 4, "\xc4\xa4", 2, "H", 1 },
+    // LATIN SMALL LETTER H WITH CIRCUMFLEX
+    { "#293", 4, "\xc4\xa5", 2, "h", 1 },
+    // LATIN CAPITAL LETTER H WITH STROKE
+    { "#294", 4, "\xc4\xa6", 2, "H", 1 },
+    // LATIN SMALL LETTER H WITH STROKE
+    { "#295", 4, "\xc4\xa7", 2, "h", 1 },
+    // LATIN CAPITAL LETTER I WITH TILDE
+    { "#296", 4, "\xc4\xa8", 2, "I", 1 },
+    // LATIN SMALL LETTER I WITH TILDE
+    { "#297", 4, "\xc4\xa9", 2, "i", 1 },
+    // LATIN CAPITAL LETTER I WITH MACRON
+    { "#298", 4, "\xc4\xaa", 2, "I", 1 },
+    // LATIN SMALL LETTER I WITH MACRON
+    { "#299", 4, "\xc4\xab", 2, "i", 1 },
+    // LATIN CAPITAL LETTER I WITH OGONEK
+    { "#302", 4, "\xc4\xae", 2, "I", 1 },
+    // LATIN SMALL LETTER I WITH OGONEK
+    { "#303", 4, "\xc4\xaf", 2, "i", 1 },
+    // LATIN CAPITAL LETTER I WITH DOT ABOVE
+    { "#304", 4, "\xc4\xb0", 2, "I", 1 },
+    // LATIN SMALL LETTER DOTLESS I
+    { "#305", 4, "\xc4\xb1", 2, "i", 1 },
+    // LATIN CAPITAL LETTER J WITH CIRCUMFLEX
+    { "#308", 4, "\xc4\xb4", 2, "J", 1 },
+    // LATIN SMALL LETTER J WITH CIRCUMFLEX
+    { "#309", 4, "\xc4\xb5", 2, "j", 1 },
+    // LATIN CAPITAL LETTER L WITH CEDILLA
+    { "#310", 4, "\xc4\xb6", 2, "L", 1 },
+    // LATIN SMALL LETTER L WITH CEDILLA
+    { "#311", 4, "\xc4\xb7", 2, "l", 1 },
+    // LATIN SMALL LETTER KRA
+    { "#312", 4, "\xc4\xb8", 2, "K", 1 },
+    // LATIN CAPITAL LETTER L WITH ACUTE
+    { "#313", 4, "\xc4\xb9", 2, "L", 1 },
+    // LATIN SMALL LETTER L WITH ACUTE
+    { "#314", 4, "\xc4\xba", 2, "l", 1 },
+    // LATIN CAPITAL LETTER L WITH CEDILLA
+    { "#315", 4, "\xc4\xbb", 2, "L", 1 },
+    // LATIN SMALL LETTER L WITH CEDILLA
+    { "#316", 4, "\xc4\xbc", 2, "l", 1 },
+    // LATIN CAPITAL LETTER L WITH CARON
+    { "#317", 4, "\xc4\xbd", 2, "L", 1 },
+    // LATIN SMALL LETTER L WITH CARON
+    { "#318", 4, "\xc4\xbe", 2, "l", 1 },
+    // LATIN CAPITAL LETTER L WITH MIDDLE DOT
+    { "#319", 4, "\xc4\xbf", 2, "L", 1 },
+    // LATIN SMALL LETTER L WITH MIDDLE DOT
+    { "#320", 4, "\xc5\x80", 2, "l", 1 },
+    // LATIN CAPITAL LETTER L WITH STROKE
+    { "#321", 4, "\xc5\x81", 2, "L", 1 },
+    // LATIN SMALL LETTER L WITH STROKE
+    { "#322", 4, "\xc5\x82", 2, "l", 1 },
+    // LATIN CAPITAL LETTER L WITH ACUTE
+    { "#323", 4, "\xc5\x83", 2, "L", 1 },
+    // LATIN SMALL LETTER L WITH ACUTE
+    { "#324", 4, "\xc5\x84", 2, "l", 1 },
+    // LATIN CAPITAL LETTER N WITH CEDILLA
+    { "#325", 4, "\xc5\x85", 2, "N", 1 },
+    // LATIN SMALL LETTER N WITH CEDILLA
+    { "#326", 4, "\xc5\x86", 2, "n", 1 },
+    // LATIN CAPITAL LETTER N WITH ACUTE
+    { "#327", 4, "\xc5\x87", 2, "N", 1 },
+    // LATIN SMALL LETTER N WITH ACUTE
+    { "#328", 4, "\xc5\x88", 2, "n", 1 },
+    // LATIN CAPITAL LETTER ENG
+    { "#330", 4, "\xc5\x8a", 2, "N", 1 },
+    // LATIN SMALL LETTER ENG
+    { "#331", 4, "\xc5\x8b", 2, "n", 1 },
+    // LATIN CAPITAL O LETTER WITH MACRON
+    { "#332", 4, "\xc5\x8c", 2, "O", 1 },
+    // LATIN SMALL O LETTER WITH MACRON
+    { "#333", 4, "\xc5\x8d", 2, "o", 1 },
+    // LATIN CAPITAL LETTER O WITH DOUBLE ACUTE
+    { "#336", 4, "\xc5\x90", 2, "O", 1 },
+    // LATIN SMALL LETTER O WITH DOUBLE ACUTE
+    { "#337", 4, "\xc5\x91", 2, "o", 1 },
+    // LATIN CAPITAL LETTER R WITH CEDILLA
+    { "#342", 4, "\xc5\x96", 2, "R", 1 },
+    // LATIN SMALL LETTER R WITH CEDILLA
+    { "#343", 4, "\xc5\x97", 2, "r", 1 },
+    // LATIN CAPITAL LETTER R WITH CARON
+    { "#344", 4, "\xc5\x98", 2, "R", 1 },
+    // LATIN SMALL LETTER R WITH CARON
+    { "#345", 4, "\xc5\x99", 2, "r", 1 },
+    // LATIN CAPITAL LETTER S WITH ACUTE
+    { "#346", 4, "\xc5\x9a", 2, "S", 1 },
+    // LATIN SMALL LETTER S WITH ACUTE
+    { "#347", 4, "\xc5\x9b", 2, "s", 1 },
+    // LATIN CAPITAL LETTER S WITH CIRCUMFLEX
+    { "#348", 4, "\xc5\x9c", 2, "S", 1 },
+    // LATIN SMALL LETTER S WITH CIRCUMFLEX
+    { "#349", 4, "\xc5\x9d", 2, "s", 1 },
+    // LATIN CAPITAL LETTER S WITH CEDILLA
+    { "#350", 4, "\xc5\x9e", 2, "S", 1 },
+    // LATIN SMALL LETTER S WITH CEDILLA
+    { "#351", 4, "\xc5\x9f", 2, "s", 1 },
+    // LATIN CAPITAL LETTER T WITH CARON
+    { "#356", 4, "\xc5\xa4", 2, "T", 1 },
+    // LATIN SMALL LETTER T WITH CARON
+    { "#357", 4, "\xc5\xa5", 2, "t", 1 },
+    // LATIN CAPITAL LETTER T WITH STROKE
+    { "#358", 4, "\xc5\xa6", 2, "T", 1 },
+    // LATIN SMALL LETTER T WITH STROKE
+    { "#359", 4, "\xc5\xa7", 2, "t", 1 },
+    // LATIN CAPITAL LETTER U WITH TILDE
+    { "#360", 4, "\xc5\xa8", 2, "U", 1 },
+    // LATIN SMALL LETTER U WITH TILDE
+    { "#361", 4, "\xc5\xa9", 2, "u", 1 },
+    // LATIN CAPITAL LETTER U WITH MACRON
+    { "#362", 4, "\xc5\xaa", 2, "U", 1 },
+    // LATIN SMALL LETTER U WITH MACRON
+    { "#363", 4, "\xc5\xab", 2, "u", 1 },
+    // LATIN CAPITAL LETTER U WITH BREVE
+    { "#364", 4, "\xc5\xac", 2, "U", 1 },
+    // LATIN SMALL LETTER U WITH BREVE
+    { "#365", 4, "\xc5\xad", 2, "u", 1 },
+    // LATIN CAPITAL LETTER U WITH RING ABOVE
+    { "#366", 4, "\xc5\xae", 2, "U", 1 },
+    // LATIN SMALL LETTER U WITH RING ABOVE
+    { "#367", 4, "\xc5\xaf", 2, "u", 1 },
+    // LATIN CAPITAL LETTER U WITH DOUBLE ACUTE
+    { "#368", 4, "\xc5\xb0", 2, "U", 1 },
+    // LATIN SMALL LETTER U WITH DOUBLE ACUTE
+    { "#369", 4, "\xc5\xb1", 2, "u", 1 },
+    // LATIN CAPITAL LETTER U WITH OGONEK
+    { "#370", 4, "\xc5\xb2", 2, "U", 1 },
+    // LATIN SMALL LETTER U WITH OGONEK
+    { "#371", 4, "\xc5\xb3", 2, "u", 1 },
+    // LATIN CAPITAL LETTER W WITH CIRCUMFLEX
+    { "#372", 4, "\xc5\xb4", 2, "W", 1 },
+    // LATIN SMALL LETTER W WITH CIRCUMFLEX
+    { "#373", 4, "\xc5\xb5", 2, "w", 1 },
+    // LATIN CAPITAL LETTER Y WITH CIRCUMFLEX
+    { "#374", 4, "\xc5\xb6", 2, "Y", 1 },
+    // LATIN SMALL LETTER Y WITH CIRCUMFLEX
+    { "#375", 4, "\xc5\xb7", 2, "y", 1 },
+    // LATIN CAPITAL LETTER Z WITH ACUTE
+    { "#377", 4, "\xc5\xb9", 2, "Z", 1 },
+    // LATIN SMALL LETTER Z WITH ACUTE
+    { "#378", 4, "\xc5\xba", 2, "z", 1 },
+    // LATIN CAPITAL LETTER Z WITH DOT ABOVE
+    { "#379", 4, "\xc5\xbb", 2, "Z", 1 },
+    // LATIN SMALL LETTER Z WITH DOT ABOVE
+    { "#380", 4, "\xc5\xbc", 2, "z", 1 },
+    // LATIN CAPITAL LETTER Z WITH CARON
+    { "#381", 4, "\xc5\xbd", 2, "Z", 1 },
+    // LATIN SMALL LETTER Z WITH CARON
+    { "#382", 4, "\xc5\xbe", 2, "z", 1 },
+    // LATIN CAPITAL LETTER T WITH COMMA BELOW
+    { "#538", 4, "\xc8\x9a", 2, "T", 1 },
+    // LATIN SMALL LETTER T WITH COMMA BELOW
+    { "#539", 4, "\xc8\x9b", 2, "t", 1 },
+    // LATIN CAPITAL LETTER E WITH CEDILLA
+    { "#552", 4, "\xc8\xa8", 2, "E", 1 },
+    // LATIN SMALL LETTER E WITH CEDILLA
+    { "#553", 4, "\xc8\xa9", 2, "e", 1 },
+    // EIGHTH NOTE
+    { "#9834", 5, "\xe2\x99\xaa", 3, "", 0 },
+    // OHM SIGN
+    { "#8486", 5, "\xe2\x84\xa6", 3, "O", 1 },
+    // FULL BLOCK
+    { "#9608", 5, "\xe2\x96\x88", 3, " ", 1 },
+    // LATIN SMALL LETTER A WITH DIAERESIS
+    { "auml", 4, "\xc3\xa4", 2, "a", 1 },
+    // LATIN SMALL LETTER A WITH TILDE
+    { "atilde", 6, "\xc3\xa3", 2, "a", 1 },
+    // LATIN SMALL LETTER A WITH RING ABOVE
+    { "aring", 5, "\xc3\xa5", 2, "a", 1 },
+    // AMPERSAND
+    { "amp", 3, "&", 1, "&", 1 },
+    // APOSTROPHE
+    { "apos", 4, "'", 1, "'", 1 },
+    // LATIN SMALL LETTER ALPHA
+    { "alpha", 5, "\xc9\x91", 2, "a", 1 },
+    // LATIN SMALL LETTER AE
+    { "aelig", 5, "\xc3\xa6", 2, "a", 1 },
+    // LATIN SMALL LETTER A WITH ACUTE
+    { "aacute", 6, "\xc3\xa1", 2, "a", 1 },
+    // LATIN SMALL LETTER A WITH GRAVE
+    { "agrave", 6, "\xc3\xa0", 2, "a", 1 },
+    // LATIN SMALL LETTER A WITH CIRCUMFLEX
+    { "acirc", 5, "\xc3\xa2", 2, "a", 1 },
+    // LATIN CAPITAL LETTER A WITH DIAERESIS
+    { "Auml", 4, "\xc3\x84", 2, "A", 1 },
+    // LATIN CAPITAL LETTER A WITH TILDE
+    { "Atilde", 6, "\xc3\x83", 2, "A", 1 },
+    // LATIN CAPITAL LETTER A WITH RING ABOVE
+    { "Aring", 5, "\xc3\x85", 2, "A", 1 },
+    // LATIN CAPITAL LETTER AE
+    { "AElig", 5, "\xc3\x86", 2, "A", 1 },
+    // LATIN CAPITAL LETTER A WITH ACUTE
+    { "Aacute", 6, "\xc3\x81", 2, "A", 1 },
+    // LATIN CAPITAL LETTER A WITH GRAVE
+    { "Agrave", 6, "\xc3\x80", 2, "A", 1 },
+    // LATIN CAPITAL LETTER A WITH CIRCUMFLEX
+    { "Acirc", 5, "\xc3\x82", 2, "A", 1 },
+    // CURRENCY SIGN
+    { "curren", 6, "\xc2\xa4", 2, "c", 1 },
+    // COPYRIGHT SIGN
+    { "copy", 4, "\xc2\xa9", 2, "c", 1 },
+    // LATIN SMALL LETTER C WITH CEDILLA
+    { "ccedil", 6, "\xc3\xa7", 2, "c", 1 },
+    // LATIN CAPITAL LETTER C WITH CEDILLA
+    { "Ccedil", 6, "\xc3\x87", 2, "C", 1 },
+    // DEGREE SIGN
+    { "deg", 3, "\xc2\xb0", 2, "o", 1 },
+    // DOWNWARDS ARROW
+    { "darr", 4, "\xe2\x86\x93", 3, "Y", 1 },
+    // LATIN SMALL LETTER E WITH ACUTE
+    { "eacute", 6, "\xc3\xa9", 2, "e", 1 },
+    // EURO SIGN
+    { "euro", 4, "\xe2\x82\xac", 3, "e", 1 },
+    // LATIN SMALL LETTER ETH
+    { "eth", 3, "\xc3\xb0", 2, "e", 1 },
+    // LATIN SMALL LETTER E WITH GRAVE
+    { "egrave", 6, "\xc3\xa8", 2, "e", 1 },
+    // LATIN SMALL LETTER E WITH DIAERESIS
+    { "euml", 4, "\xc3\xab", 2, "e", 1 },
+    // LATIN SMALL LETTER E WITH CIRCUMFLEX
+    { "ecirc", 5, "\xc3\xaa", 2, "e", 1 },
+    // LATIN CAPITAL LETTER E WITH ACUTE
+    { "Eacute", 6, "\xc3\x89", 2, "E", 1 },
+    // LATIN CAPITAL LETTER ETH
+    { "ETH", 3, "\xc3\x90", 2, "E", 1 },
+    // LATIN CAPITAL LETTER E WITH GRAVE
+    { "Egrave", 6, "\xc3\x88", 2, "E", 1 },
+    // LATIN CAPITAL LETTER E WITH DIAERESIS
+    { "Euml", 4, "\xc3\x8b", 2, "E", 1 },
+    // LATIN CAPITAL LETTER E WITH CIRCUMFLEX
+    { "Ecirc", 5, "\xc3\x8a", 2, "E", 1 },
+    // VULGAR FRACTION ONE HALF
+    { "frac12", 6, "\xc2\xbd", 2, "1/2", 3 },
+    // GREATER-THAN SIGN
+    { "gt", 2, ">", 1, ">", 1 },
+    // INVERTED EXCLAMATION MARK
+    { "iexcl", 5, "\xc2\xa1", 2, "!", 1 },
+    // INVERTED QUESTION MARK
+    { "iquest", 6, "\xc2\xbf", 2, "?", 1 },
+    // LATIN SMALL LETTER I WITH ACUTE
+    { "iacute", 6, "\xc3\xad", 2, "i", 1 },
+    // LATIN SMALL LETTER I WITH GRAVE
+    { "igrave", 6, "\xc3\xac", 2, "i", 1 },
+    // LATIN SMALL LETTER I WITH DIAERESIS
+    { "iuml", 4, "\xc3\xaf", 2, "i", 1 },
+    // LATIN SMALL LETTER I WITH CIRCUMFLEX
+    { "icirc", 5, "\xc3\xae", 2, "i", 1 },
+    // LATIN CAPITAL LETTER I WITH ACUTE
+    { "Iacute", 6, "\xc3\x8d", 2, "I", 1 },
+    // LATIN CAPITAL LETTER I WITH GRAVE
+    { "Igrave", 6, "\xc3\x8c", 2, "I", 1 },
+    // LATIN CAPITAL LETTER I WITH DIAERESIS
+    { "Iuml", 4, "\xc3\x8f", 2, "I", 1 },
+    // LATIN CAPITAL LETTER I WITH CIRCUMFLEX
+    { "Icirc", 5, "\xc3\x8e", 2, "I", 1 },
+    // LESS-THAN SIGN
+    { "lt", 2, "<", 1, "<", 1 },
+    // LEFT-POINTING DOUBLE ANGLE QUOTATION MARK
+    { "laquo", 5, "\xc2\xab", 2, "<", 1 },
+    // LEFTWARDS ARROW
+    { "larr", 4, "\xe2\x86\x90", 3, "<", 1 },
+    // MIDDLE DOT
+    { "middot", 6, "\xc2\xb7", 2, ".", 1 },
+    // EN DASH
+    { "ndash", 5, "\xe2\x80\x93", 3, "-", 1 },
+    // LATIN SMALL LETTER N WITH TILDE
+    { "ntilde", 6, "\xc3\xb1", 2, "n", 1 },
+    // LATIN CAPITAL LETTER N WITH TILDE
+    { "Ntilde", 6, "\xc3\x91", 2, "N", 1 },
+    // LATIN SMALL LETTER O WITH DIAERESIS
+    { "ouml", 4, "\xc3\xb6", 2, "o", 1 },
+    // LATIN SMALL LETTER O WITH STROKE
+    { "oslash", 6, "\xc3\xb8", 2, "o", 1 },
+    // LATIN SMALL LIGATURE OE
+    { "oelig", 5, "\xc5\x93", 2, "oe", 2 },
+    // LATIN SMALL LETTER O WITH ACUTE
+    { "oacute", 6, "\xc3\xb3", 2, "o", 1 },
+    // LATIN SMALL LETTER O WITH GRAVE
+    { "ograve", 6, "\xc3\xb2", 2, "o", 1 },
+    // LATIN SMALL LETTER O WITH TILDE
+    { "otilde", 6, "\xc3\xb5", 2, "o", 1 },
+    // LATIN SMALL LETTER O WITH CIRCUMFLEX
+    { "ocirc", 5, "\xc3\xb4", 2, "o", 1 },
+    // LATIN CAPITAL LETTER O WITH DIAERESIS
+    { "Ouml", 4, "\xc3\x96", 2, "O", 1 },
+    // LATIN CAPITAL LETTER O WITH STROKE
+    { "Oslash", 6, "\xc3\x98", 2, "O", 1 },
+    // LATIN CAPITAL LIGATURE OE
+    { "OElig", 5, "\xc5\x92", 2, "OE", 2 },
+    // LATIN CAPITAL LETTER O WITH ACUTE
+    { "Oacute", 6, "\xc3\x93", 2, "O", 1 },
+    // LATIN CAPITAL LETTER O WITH GRAVE
+    { "Ograve", 6, "\xc3\x92", 2, "O", 1 },
+    // LATIN CAPITAL LETTER O WITH TILDE
+    { "Otilde", 6, "\xc3\x95", 2, "O", 1 },
+    // LATIN CAPITAL LETTER O WITH CIRCUMFLEX
+    { "Ocirc", 5, "\xc3\x94", 2, "O", 1 },
+    // POUND SIGN
+    { "pound", 5, "\xc2\xa3", 2, "p", 1 },
+    // PLUS-MINUS SIGN
+    { "plusmn", 6, "\xc2\xb1", 2, "+/-", 3 },
+    // PER MILLE SIGN
+    { "permil", 6, "\xe2\x80\xb0", 3, "p", 1 },
+    // QUOTATION MARK
+    { "quot", 4, "\"", 1, "\"", 1 },
+    // RIGHT-POINTING DOUBLE ANGLE QUOTATION MARK
+    { "raquo", 5, "\xc2\xbb", 2, ">", 1 },
+    // RIGHTWARDS ARROW
+    { "rarr", 4, "\xe2\x86\x92", 3, ">", 1 },
+    // RIGHT DOUBLE QUOTATION MARK
+    { "rdquo", 5, "\xe2\x80\x9d", 3, "\"", 1 },
+    // SECTION SIGN
+    { "sect", 4, "\xc2\xa7", 2, "s", 1 },
+    // LATIN SMALL LETTER SHARP S
+    { "szlig", 5, "\xc3\x9f", 2, "B", 1 },
+    // LATIN SMALL LETTER S WITH CARON
+    { "scaron", 6, "\xc5\xa1", 2, "s", 1 },
+    // SUPERSCRIPT ONE
+    { "sup1", 4, "\xc2\xb9", 2, "1", 1 },
+    // SUPERSCRIPT TWO
+    { "sup2", 4, "\xc2\xb2", 2, "2", 1 },
+    // SUPERSCRIPT THREE
+    { "sup3", 4, "\xc2\xb3", 2, "3", 1 },
+    // LATIN CAPITAL LETTER S WITH CARON
+    { "Scaron", 6, "\xc5\xa0", 2, "S", 1 },
+    // LATIN SMALL LETTER THORN
+    { "thorn", 5, "\xc3\xbe", 2, "t", 1 },
+    // LATIN CAPITAL LETTER THORN
+    { "THORN", 5, "\xc3\x9e", 2, "T", 1 },
+    // LATIN SMALL LETTER U WITH DIAERESIS
+    { "uuml", 4, "\xc3\xbc", 2, "u", 1 },
+    // UPWARDS ARROW
+    { "uarr", 4, "\xe2\x86\x91", 3, "^", 1 },
+    // LATIN SMALL LETTER U WITH ACUTE
+    { "uacute", 6, "\xc3\xba", 2, "u", 1 },
+    // LATIN SMALL LETTER U WITH GRAVE
+    { "ugrave", 6, "\xc3\xb9", 2, "u", 1 },
+    // LATIN SMALL LETTER U WITH CIRCUMFLEX
+    { "ucirc", 5, "\xc3\xbb", 2, "u", 1 },
+    // LATIN CAPITAL LETTER U WITH DIAERESIS
+    { "Uuml", 4, "\xc3\x9c", 2, "U", 1 },
+    // LATIN CAPITAL LETTER U WITH ACUTE
+    { "Uacute", 6, "\xc3\x9a", 2, "U", 1 },
+    // LATIN CAPITAL LETTER U WITH GRAVE
+    { "Ugrave", 6, "\xc3\x99", 2, "U", 1 },
+    // LATIN CAPITAL LETTER U WITH CIRCUMFLEX
+    { "Ucirc", 5, "\xc3\x9b", 2, "U", 1 },
+    // LATIN SMALL LETTER Y WITH ACUTE
+    { "yacute", 6, "\xc3\xbd", 2, "y", 1 },
+    // LATIN SMALL LETTER Y WITH DIAERESIS
+    { "yuml", 4, "\xc3\xbf", 2, "y", 1 },
+    // LATIN CAPITAL LETTER Y WITH ACUTE
+    { "Yacute", 6, "\xc3\x9d", 2, "Y", 1 },
+    // LATIN CAPITAL LETTER Y WITH DIAERESIS
+    { "Yuml", 4, "\xc5\xb8", 2, "Y", 1 },
+    // NO-BREAK SPACE
+    { "nbsp", 4, " ", 1, " ", 1 },
+};
+
+static const uint16_t html_entity_seeds[HTML_ENTITY_BUCKETS] = {
+    1, 21, 1, 21, 3, 0, 5, 1, 1, 5, 1, 1,
+    21, 4, 8, 1, 2, 6, 1, 1, 0, 1, 15, 7,
+    67, 1, 21, 0, 5, 8, 30, 1, 23, 8, 1, 5,
+    5, 3, 40, 2, 13, 22, 21, 25, 8, 13, 2, 2,
+    45, 1, 57, 3, 5, 3, 20, 23, 9, 3, 14, 36,
+    7, 2, 36, 41,
+};
+
+// Index + 1 to html_entities, 0 means that the slot is empty
+static const uint8_t html_entity_slots[HTML_ENTITY_SLOTS] = {
+    55, 205, 0, 84, 156, 117, 207, 36, 0, 139, 9, 164, 154, 23, 119, 110,
+    97, 0, 116, 127, 140, 98, 196, 83, 176, 0, 46, 85, 69, 0, 125, 181,
+    89, 94, 12, 0, 11, 77, 81, 153, 134, 177, 43, 169, 103, 173, 48, 151,
+    57, 186, 189, 4, 107, 80, 132, 33, 0, 54, 160, 188, 29, 0, 180, 0,
+    118, 0, 148, 71, 129, 115, 21, 124, 184, 0, 163, 0, 144, 42, 108, 157,
+    201, 18, 7, 142, 105, 102, 174, 0, 88, 19, 61, 143, 122, 175, 0, 0,
+    0, 194, 31, 0, 209, 0, 24, 99, 149, 16, 172, 96, 17, 192, 76, 130,
+    0, 0, 0, 179, 0, 120, 79, 6, 35, 91, 27, 131, 191, 0, 90, 87,
+    146, 0, 82, 0, 111, 3, 109, 34, 159, 101, 73, 39, 167, 136, 78, 0,
+    86, 0, 0, 114, 10, 155, 28, 206, 63, 51, 95, 45, 41, 168, 64, 93,
+    135, 121, 59, 0, 0, 183, 158, 1, 128, 13, 92, 8, 67, 202, 52, 68,
+    70, 138, 5, 38, 62, 137, 147, 208, 74, 200, 150, 203, 0, 44, 0, 187,
+    106, 195, 66, 47, 0, 0, 0, 20, 53, 100, 0, 104, 30, 32, 126, 58,
+    0, 166, 65, 190, 37, 171, 15, 25, 0, 22, 152, 0, 193, 0, 72, 60,
+    0, 133, 182, 113, 112, 0, 0, 14, 204, 2, 145, 178, 26, 162, 197, 56,
+    199, 0, 75, 0, 198, 165, 0, 50, 141, 185, 40, 161, 0, 49, 170, 123,
+};
+
+/**
+ * FNV-1a hash of the entity name. Seed 0 selects the bucket and the bucket's
+ * seed selects the final slot, which makes the lookup collision free.
+ */
+static inline uint32_t html_entity_hash(uint32_t seed, const char* name, size_t len)
+{
+    uint32_t hash = 2166136261u ^ seed;
+    for (size_t i = 0; i < len; i++)
+        hash = (hash ^ (unsigned char)name[i]) * 16777619u;
+    return hash;
+}
+
+#endif
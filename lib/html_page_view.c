@@ -0,0 +1,323 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tekstitv.h>
+
+#include "html_scan.h"
+#include "html_tokens.h"
+
+typedef struct {
+    html_page_view* view;
+    html_buffer buffer;
+    // Growing one of the view's arrays failed
+    bool failed;
+} view_parser;
+
+/**
+ * Grow the array so it fits at least needed items.
+ * Returns NULL and leaves the array untouched if the allocation fails.
+ */
+static void* grow_array(void* data, size_t* capacity, size_t needed, size_t item_size)
+{
+    if (data != NULL && needed <= *capacity)
+        return data;
+
+    size_t new_capacity = *capacity > 0 ? *capacity : 64;
+    while (new_capacity < needed)
+        new_capacity *= 2;
+
+    data = realloc(data, new_capacity * item_size);
+    if (data != NULL)
+        *capacity = new_capacity;
+    return data;
+}
+
+static html_span make_span(view_parser* parser, const char* text, size_t size, bool decode)
+{
+    html_page_view* view = parser->view;
+    html_span span;
+    span.offset = text - view->html;
+    span.size = size;
+    span.decoded = false;
+
+    if (!decode || memchr(text, '&', size) == NULL)
+        return span;
+
+    // Decoded text is never longer than the encoded one
+    char* decoded = grow_array(view->decoded, &view->decoded_capacity, view->decoded_size + size, 1);
+    if (decoded == NULL) {
+        parser->failed = true;
+        return span;
+    }
+
+    view->decoded = decoded;
+    span.offset = view->decoded_size;
+    span.size = copy_html_text(view->decoded + view->decoded_size, text, size);
+    span.decoded = true;
+    view->decoded_size += span.size;
+    return span;
+}
+
+static void append_item(view_parser* parser, html_row_view* row, html_item_view item)
+{
+    html_page_view* view = parser->view;
+    html_item_view* items = grow_array(view->items, &view->items_capacity, view->items_size + 1, sizeof(html_item_view));
+    if (items == NULL) {
+        parser->failed = true;
+        return;
+    }
+
+    view->items = items;
+    view->items[view->items_size++] = item;
+    row->size++;
+}
+
+static void parse_link(view_parser* parser, html_buffer* buffer, html_item_view* item, size_t pre_space)
+{
+    skip_next_str(buffer, "href", 4);
+    skip_next_char(buffer, '=');
+    skip_next_char(buffer, '"');
+
+    size_t link_len = get_text_size_until(buffer, '"');
+
+    item->type = HTML_LINK;
+    item->pre_space = pre_space;
+    item->url = make_span(parser, buffer->html + buffer->current, link_len, false);
+
+    // go to end of the opening a tag
+    skip_next_char(buffer, '>');
+
+    size_t text_len = get_current_text_size(buffer);
+    item->text = make_span(parser, buffer->html + buffer->current, text_len, true);
+
+    skip_next_tag(buffer, "a", 1, true);
+}
+
+static void parse_title(view_parser* parser)
+{
+    html_buffer* buffer = &parser->buffer;
+    skip_next_tag(buffer, "big", 3, false);
+
+    size_t title_len = get_text_size_until(buffer, '<');
+
+    parser->view->title = make_span(parser, buffer->html + buffer->current, title_len, false);
+    buffer->current += title_len;
+    skip_next_tag(buffer, "big", 3, true);
+}
+
+static void parse_top_navigation(view_parser* parser)
+{
+    html_buffer* buffer = &parser->buffer;
+    for (size_t i = 0; i < TOP_NAVIGATION_SIZE; i++) {
+        html_item_view* item = &parser->view->top_navigation[i];
+        bool last_link = i == TOP_NAVIGATION_SIZE - 1;
+        if (i != 0)
+            skip_next_str(buffer, "&nbsp;", 6);
+
+        if (get_tag_type(buffer) == LINK) {
+            parse_link(parser, buffer, item, 0);
+        } else {
+            size_t text_len = get_text_size_until(buffer, last_link ? '<' : '&');
+
+            item->type = HTML_TEXT;
+            item->text = make_span(parser, buffer->html + buffer->current, text_len, false);
+            buffer->current += text_len;
+        }
+
+        if (!last_link)
+            skip_next_str(buffer, "&nbsp;|", 7);
+    }
+}
+
+static void parse_middle_line(view_parser* parser, html_row_view* row, html_buffer* line)
+{
+    if (line->size == 0 || line->html[0] == '&')
+        return;
+
+    size_t pre_space = 0;
+    while (pre_space < line->size && line->html[pre_space] == ' ')
+        pre_space++;
+
+    // Same as html_parser, rows without the leading spaces have no items
+    if (pre_space == 0)
+        return;
+
+    // Start from the last space, it's part of the first item
+    for (line->current = pre_space - 1; line->current < line->size && !parser->failed; line->current++) {
+        html_item_view item;
+        if (get_tag_type(line) == LINK) {
+            parse_link(parser, line, &item, pre_space);
+            // Turn invalid links to text items
+            if (item.url.size != HTML_LINK_SIZE)
+                item.type = HTML_TEXT;
+            append_item(parser, row, item);
+            line->current--; // Don't miss the next starting character
+        } else {
+            size_t text_len = get_current_text_size(line);
+            // Ignore empty texts
+            if (text_len == 0)
+                continue;
+
+            item.type = HTML_TEXT;
+            item.pre_space = pre_space;
+            item.text = make_span(parser, line->html + line->current, text_len, true);
+            append_item(parser, row, item);
+            line->current += text_len;
+        }
+        pre_space = 0;
+    }
+}
+
+static void parse_middle(view_parser* parser)
+{
+    html_page_view* view = parser->view;
+    html_buffer* buffer = &parser->buffer;
+
+    skip_next_tag(buffer, "pre", 3, false);
+    // Loop until the closing pre tag is found
+    while (buffer->current < buffer->size && !buffer_at_str(buffer, "</pre>", 6) && !parser->failed) {
+        html_row_view* rows = grow_array(view->middle, &view->middle_capacity, view->middle_rows + 1, sizeof(html_row_view));
+        if (rows == NULL) {
+            parser->failed = true;
+            return;
+        }
+
+        view->middle = rows;
+        html_row_view* row = &view->middle[view->middle_rows++];
+        row->first = view->items_size;
+        row->size = 0;
+
+        // The line is parsed in place, only the end of it is moved
+        html_buffer line;
+        line.html = buffer->html + buffer->current;
+        line.size = html_scan.find_char(line.html, buffer->size - buffer->current, '\n');
+        line.capacity = line.size;
+        line.current = 0;
+        line.limit = line.size;
+        parse_middle_line(parser, row, &line);
+
+        // Skip the newline too
+        buffer->current += line.size + 1;
+    }
+
+    // Truncated page without the closing pre tag
+    if (buffer->current > buffer->size)
+        buffer->current = buffer->size;
+}
+
+static void parse_sub_pages(view_parser* parser)
+{
+    html_page_view* view = parser->view;
+    html_buffer* buffer = &parser->buffer;
+
+    view->sub_pages.first = view->items_size;
+    skip_next_tag(buffer, "p", 1, false);
+    while (buffer->current < buffer->size && !buffer_at_str(buffer, "</p", 3) && !parser->failed) {
+        html_item_view item;
+        switch (get_tag_type(buffer)) {
+        case UNKNOWN: {
+            // In this context UNKNOWN means regular text
+            size_t text_size = get_current_text_size(buffer);
+            // Unknown tag or a truncated page, nothing more can be parsed
+            if (text_size == 0)
+                return;
+            item.type = HTML_TEXT;
+            item.pre_space = 0;
+            item.text = make_span(parser, buffer->html + buffer->current, text_size, false);
+            buffer->current += text_size;
+        } break;
+        case LINK:
+            parse_link(parser, buffer, &item, 0);
+            break;
+        case FONT:
+            skip_next_tag(buffer, "font", 4, true);
+            continue;
+        default:
+            // Nothing else is expected between the sub page links
+            return;
+        }
+
+        append_item(parser, &view->sub_pages, item);
+    }
+}
+
+static void parse_bottom_navigation(view_parser* parser)
+{
+    skip_next_tag(&parser->buffer, "p", 1, false);
+    for (size_t i = 0; i < BOTTOM_NAVIGATION_SIZE; i++)
+        parse_link(parser, &parser->buffer, &parser->view->bottom_navigation[i], 0);
+}
+
+void init_html_page_view(html_page_view* view)
+{
+    memset(view, 0, sizeof(html_page_view));
+}
+
+void free_html_page_view(html_page_view* view)
+{
+    free(view->middle);
+    free(view->items);
+    free(view->decoded);
+    init_html_page_view(view);
+}
+
+/**
+ * Parse the whole page to the view.
+ * Returns false if the page doesn't exist or there was not enough memory
+ * to parse all of it.
+ */
+bool parse_html_page_view(html_page_view* view, const char* html, size_t size)
+{
+    view->html = html;
+    view->html_size = size;
+    view->invalid = false;
+    view->middle_rows = 0;
+    view->items_size = 0;
+    view->decoded_size = 0;
+    memset(&view->title, 0, sizeof(html_span));
+    memset(view->top_navigation, 0, sizeof(view->top_navigation));
+    memset(view->bottom_navigation, 0, sizeof(view->bottom_navigation));
+    memset(&view->sub_pages, 0, sizeof(html_row_view));
+
+    // Spans can't point past 4 GB
+    if (size > UINT32_MAX)
+        return false;
+
+    view_parser parser;
+    parser.view = view;
+    parser.failed = false;
+    // The helpers only read the html
+    parser.buffer.html = (char*)html;
+    parser.buffer.size = size;
+    parser.buffer.capacity = size;
+    parser.buffer.current = 0;
+    parser.buffer.limit = size;
+
+    if (!check_valid_page(&parser.buffer)) {
+        view->invalid = true;
+        return false;
+    }
+
+    html_buffer* buffer = &parser.buffer;
+    skip_next_tag(buffer, "p", 1, false);
+    parse_title(&parser);
+    skip_next_tag(buffer, "p", 1, true);
+
+    skip_next_tag(buffer, "SPAN", 4, false);
+    parse_top_navigation(&parser);
+    skip_next_tag(buffer, "SPAN", 4, true);
+
+    skip_next_tag(buffer, "DIV", 3, false);
+    parse_middle(&parser);
+    skip_next_tag(buffer, "DIV", 3, true);
+
+    skip_next_tag(buffer, "DIV", 3, false);
+    parse_sub_pages(&parser);
+    skip_next_tag(buffer, "DIV", 3, true);
+
+    skip_next_tag(buffer, "DIV", 3, true);
+    parse_bottom_navigation(&parser);
+
+    return !parser.failed;
+}
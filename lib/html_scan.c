@@ -0,0 +1,235 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "html_scan.h"
+
+/*
+ * Portable scanner
+ */
+
+static size_t find_char_portable(const char* data, size_t len, char c)
+{
+    const char* found = memchr(data, c, len);
+    return found != NULL ? (size_t)(found - data) : len;
+}
+
+static size_t find_char2_portable(const char* data, size_t len, char a, char b)
+{
+    size_t i = 0;
+    for (; i < len; i++) {
+        if (data[i] == a || data[i] == b)
+            break;
+    }
+
+    return i;
+}
+
+static size_t find_str_portable(const char* data, size_t len, const char* str, size_t str_len)
+{
+    if (str_len == 0 || str_len > len)
+        return str_len == 0 ? 0 : len;
+
+    size_t last = len - str_len;
+    for (size_t i = 0; i <= last; i++) {
+        i += find_char_portable(data + i, last - i + 1, str[0]);
+        if (i > last)
+            break;
+        if (memcmp(data + i + 1, str + 1, str_len - 1) == 0)
+            return i;
+    }
+
+    return len;
+}
+
+static const html_scanner portable_scanner = {
+    .name = "portable",
+    .find_char = find_char_portable,
+    .find_char2 = find_char2_portable,
+    .find_str = find_str_portable,
+};
+
+html_scanner html_scan = {
+    .name = "portable",
+    .find_char = find_char_portable,
+    .find_char2 = find_char2_portable,
+    .find_str = find_str_portable,
+};
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define HTML_SCAN_X86
+#include <immintrin.h>
+
+/*
+ * The vector kernels compare a whole block at once and use the
+ * resulting bit mask to find the first match. Substrings are found by
+ * comparing the first and the last character of the string at every
+ * position of the block, and only the candidates are compared fully.
+ * The tails that don't fill a block use the portable functions.
+ */
+
+#define SCAN_SSE2 __attribute__((target("sse2")))
+#define SCAN_AVX2 __attribute__((target("avx2")))
+
+static inline int first_bit(uint32_t mask)
+{
+    return __builtin_ctz(mask);
+}
+
+SCAN_SSE2 static size_t find_char_sse2(const char* data, size_t len, char c)
+{
+    const __m128i needle = _mm_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        if (mask != 0)
+            return i + first_bit(mask);
+    }
+
+    return i + find_char_portable(data + i, len - i, c);
+}
+
+SCAN_SSE2 static size_t find_char2_sse2(const char* data, size_t len, char a, char b)
+{
+    const __m128i needle_a = _mm_set1_epi8(a);
+    const __m128i needle_b = _mm_set1_epi8(b);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i match = _mm_or_si128(_mm_cmpeq_epi8(block, needle_a), _mm_cmpeq_epi8(block, needle_b));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(match);
+        if (mask != 0)
+            return i + first_bit(mask);
+    }
+
+    return i + find_char2_portable(data + i, len - i, a, b);
+}
+
+SCAN_SSE2 static size_t find_str_sse2(const char* data, size_t len, const char* str, size_t str_len)
+{
+    if (str_len < 2 || str_len > len)
+        return find_str_portable(data, len, str, str_len);
+
+    const __m128i first = _mm_set1_epi8(str[0]);
+    const __m128i last = _mm_set1_epi8(str[str_len - 1]);
+    size_t i = 0;
+    for (; i + 16 + str_len - 1 <= len; i += 16) {
+        __m128i block_first = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i block_last = _mm_loadu_si128((const __m128i*)(data + i + str_len - 1));
+        __m128i match = _mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(match);
+        while (mask != 0) {
+            int bit = first_bit(mask);
+            if (memcmp(data + i + bit + 1, str + 1, str_len - 2) == 0)
+                return i + bit;
+            mask &= mask - 1;
+        }
+    }
+
+    size_t found = find_str_portable(data + i, len - i, str, str_len);
+    return found == len - i ? len : i + found;
+}
+
+static const html_scanner sse2_scanner = {
+    .name = "sse2",
+    .find_char = find_char_sse2,
+    .find_char2 = find_char2_sse2,
+    .find_str = find_str_sse2,
+};
+
+SCAN_AVX2 static size_t find_char_avx2(const char* data, size_t len, char c)
+{
+    const __m256i needle = _mm256_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle));
+        if (mask != 0)
+            return i + first_bit(mask);
+    }
+
+    return i + find_char_sse2(data + i, len - i, c);
+}
+
+SCAN_AVX2 static size_t find_char2_avx2(const char* data, size_t len, char a, char b)
+{
+    const __m256i needle_a = _mm256_set1_epi8(a);
+    const __m256i needle_b = _mm256_set1_epi8(b);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+        __m256i match = _mm256_or_si256(_mm256_cmpeq_epi8(block, needle_a), _mm256_cmpeq_epi8(block, needle_b));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(match);
+        if (mask != 0)
+            return i + first_bit(mask);
+    }
+
+    return i + find_char2_sse2(data + i, len - i, a, b);
+}
+
+SCAN_AVX2 static size_t find_str_avx2(const char* data, size_t len, const char* str, size_t str_len)
+{
+    if (str_len < 2 || str_len > len)
+        return find_str_portable(data, len, str, str_len);
+
+    const __m256i first = _mm256_set1_epi8(str[0]);
+    const __m256i last = _mm256_set1_epi8(str[str_len - 1]);
+    size_t i = 0;
+    for (; i + 32 + str_len - 1 <= len; i += 32) {
+        __m256i block_first = _mm256_loadu_si256((const __m256i*)(data + i));
+        __m256i block_last = _mm256_loadu_si256((const __m256i*)(data + i + str_len - 1));
+        __m256i match = _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(match);
+        while (mask != 0) {
+            int bit = first_bit(mask);
+            if (memcmp(data + i + bit + 1, str + 1, str_len - 2) == 0)
+                return i + bit;
+            mask &= mask - 1;
+        }
+    }
+
+    size_t found = find_str_sse2(data + i, len - i, str, str_len);
+    return found == len - i ? len : i + found;
+}
+
+static const html_scanner avx2_scanner = {
+    .name = "avx2",
+    .find_char = find_char_avx2,
+    .find_char2 = find_char2_avx2,
+    .find_str = find_str_avx2,
+};
+
+/**
+ * Pick the scanner when the library is loaded, so the parser
+ * doesn't need to check the cpu features on every call
+ */
+__attribute__((constructor)) static void select_html_scanner(void)
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        html_scan = avx2_scanner;
+    else if (__builtin_cpu_supports("sse2"))
+        html_scan = sse2_scanner;
+}
+#endif // x86
+
+/**
+ * Fill scanners with every scanner the running cpu supports,
+ * the portable one first. Returns how many were added.
+ */
+size_t html_scan_supported(const html_scanner** scanners, size_t max)
+{
+    size_t count = 0;
+    if (count < max)
+        scanners[count++] = &portable_scanner;
+
+#ifdef HTML_SCAN_X86
+    __builtin_cpu_init();
+    if (count < max && __builtin_cpu_supports("sse2"))
+        scanners[count++] = &sse2_scanner;
+    if (count < max && __builtin_cpu_supports("avx2"))
+        scanners[count++] = &avx2_scanner;
+#endif
+
+    return count;
+}
@@ -0,0 +1,27 @@
+#ifndef _HTML_SCAN_H_
+#define _HTML_SCAN_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Shared between the library files but not exported from the shared library
+#define TEKSTITV_INTERNAL __attribute__((visibility("hidden")))
+
+/**
+ * Search primitives used by the parser. Every function returns the
+ * index of the first match in data, or len if nothing is found.
+ */
+typedef struct {
+    const char* name;
+    size_t (*find_char)(const char* data, size_t len, char c);
+    // First position of either a or b
+    size_t (*find_char2)(const char* data, size_t len, char a, char b);
+    size_t (*find_str)(const char* data, size_t len, const char* str, size_t str_len);
+} html_scanner;
+
+// Fastest scanner the running cpu supports
+TEKSTITV_INTERNAL extern html_scanner html_scan;
+
+TEKSTITV_INTERNAL size_t html_scan_supported(const html_scanner** scanners, size_t max);
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef _HTML_TOKENS_H_
+#define _HTML_TOKENS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <tekstitv.h>
+
+#include "html_scan.h"
+
+/**
+ * Helpers for walking through the page html that are shared
+ * between the html_parser and the html_page_view parsing.
+ * None of the helpers read past buffer->size.
+ */
+
+typedef enum {
+    UNKNOWN,
+    P,
+    BIG,
+    PRE,
+    LINK,
+    FONT,
+    CENTER
+} tag_type;
+
+static inline void skip_next_str(html_buffer* buffer, const char* str, size_t len)
+{
+    // find the string
+    if (buffer->current < buffer->size)
+        buffer->current += html_scan.find_str(buffer->html + buffer->current, buffer->size - buffer->current, str, len);
+
+    // Stay at the end of the buffer if the str is not found
+    if (buffer->current >= buffer->size)
+        return;
+
+    // actually skip the str
+    buffer->current += len;
+}
+
+static inline void skip_next_char(html_buffer* buffer, const char c)
+{
+    // find the char
+    if (buffer->current < buffer->size)
+        buffer->current += html_scan.find_char(buffer->html + buffer->current, buffer->size - buffer->current, c);
+
+    // Stay at the end of the buffer if the char is not found
+    if (buffer->current >= buffer->size)
+        return;
+
+    // actually skip the char
+    buffer->current++;
+}
+
+static inline void skip_next_tag(html_buffer* buffer, const char* name, size_t name_len, bool closing)
+{
+    char tag_buff[64] = { '<' };
+    int buf_len = 1;
+
+    if (closing) {
+        tag_buff[1] = '/';
+        buf_len++;
+    }
+
+    strncpy(tag_buff + buf_len, name, name_len);
+    buf_len += name_len;
+
+    skip_next_str(buffer, tag_buff, buf_len);
+    skip_next_char(buffer, '>');
+}
+
+static inline tag_type get_tag_type(html_buffer* buffer)
+{
+    if (buffer->current >= buffer->size)
+        return UNKNOWN;
+
+    char c;
+    size_t tag_len = 0;
+    const char* html = buffer->html + buffer->current;
+    size_t len = buffer->size - buffer->current;
+
+    // Skip the possible tag opener
+    if (*html == '<') {
+        html++;
+        len--;
+    }
+
+    while (tag_len < len && (c = html[tag_len]) != '\0' && c != '>' && c != ' ')
+        tag_len++;
+
+    if (tag_len == 1) {
+        if (strncmp(html, "p", 1) == 0)
+            return P;
+        if (strncmp(html, "a", 1) == 0)
+            return LINK;
+    } else if (tag_len == 3) {
+        if (strncmp(html, "big", 3) == 0)
+            return BIG;
+        if (strncmp(html, "pre", 3) == 0)
+            return PRE;
+    } else if (tag_len == 4) {
+        if (strncmp(html, "font", 4) == 0)
+            return FONT;
+    } else if (tag_len == 6) {
+        if (strncmp(html, "center", 6) == 0)
+            return CENTER;
+    }
+
+    return UNKNOWN;
+}
+
+/**
+ * How many bytes are in text in the current position
+ */
+static inline size_t get_current_text_size(html_buffer* buffer)
+{
+    if (buffer->current >= buffer->size)
+        return 0;
+
+    return html_scan.find_char2(buffer->html + buffer->current, buffer->size - buffer->current, '<', '\r');
+}
+
+/**
+ * How many bytes there are before the char in the current position.
+ * Rest of the buffer is counted if the char is not found.
+ */
+static inline size_t get_text_size_until(html_buffer* buffer, char c)
+{
+    if (buffer->current >= buffer->size)
+        return 0;
+
+    return html_scan.find_char(buffer->html + buffer->current, buffer->size - buffer->current, c);
+}
+
+/**
+ * Does the buffer continue with the string in the current position
+ */
+static inline bool buffer_at_str(html_buffer* buffer, const char* str, size_t len)
+{
+    return buffer->current <= buffer->size && buffer->size - buffer->current >= len
+        && memcmp(buffer->html + buffer->current, str, len) == 0;
+}
+
+TEKSTITV_INTERNAL size_t copy_html_text(char* target, const char* src, size_t len);
+bool check_valid_page(html_buffer* buffer);
+
+#endif
@@ -1,48 +1,507 @@
 
+#define _POSIX_C_SOURCE 200809L
 #include <curl/curl.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <tekstitv.h>
+#include <time.h>
+
+#include "disk_cache.h"
+
+// Base url and the link
+#define PAGE_URL_SIZE (PAGE_LOADER_URL_MAX + HTML_LINK_SIZE + 1)
 
 /* curl write callback, to fill html input buffer...  */
 size_t write_to_buffer(char* in, size_t size, size_t nmemb, void* out)
 {
     html_buffer* buf = (html_buffer*)out;
     size_t r = size * nmemb;
-    memcpy(buf->html + buf->size, in, r);
-    buf->size += r;
+    // Returning less than r aborts the transfer with CURLE_WRITE_ERROR
+    if (!html_buffer_append(buf, in, r))
+        return 0;
 
     return r;
 }
 
-void load_page(html_parser* parser)
+typedef struct {
+    page_loader* loader;
+    html_parser* parser;
+    // The write failed because the page didn't fit in the buffer limit
+    bool too_large;
+} page_transfer;
+
+/* curl write callback for loader_load_page, parses the page while it's loading */
+static size_t write_and_parse(char* in, size_t size, size_t nmemb, void* out)
 {
-    CURL* curl;
-    char curl_errbuf[CURL_ERROR_SIZE];
-    parser->_curl_buffer.current = 0;
-    parser->_curl_buffer.size = 0;
-    parser->curl_load_error = false;
-    int err;
-    char page[] = "https://yle.fi/tekstitv/txt/xxx_xxxx.htm";
-    memcpy(page + 28, parser->link, HTML_LINK_SIZE);
+    page_transfer* transfer = (page_transfer*)out;
+    html_parser* parser = transfer->parser;
+    html_buffer* buffer = &parser->_curl_buffer;
+    size_t r = write_to_buffer(in, size, nmemb, buffer);
+    if (r == 0) {
+        // Otherwise the buffer couldn't be allocated
+        size_t len = size * nmemb;
+        transfer->too_large = len > buffer->limit || buffer->size > buffer->limit - len;
+        return 0;
+    }
 
-    curl = curl_easy_init();
-    curl_easy_setopt(curl, CURLOPT_URL, page);
+    if (parse_html_partial(parser, false) && transfer->loader->on_progress != NULL)
+        transfer->loader->on_progress(parser, transfer->loader->progress_data);
+
+    return r;
+}
+
+static void page_url(char* url, const char* base_url, const char* link)
+{
+    snprintf(url, PAGE_URL_SIZE, "%s%.*s", base_url, HTML_LINK_SIZE, link);
+}
+
+static void reset_load_state(html_parser* parser, size_t max_page_size)
+{
+    // Memory of the previous page is reused for the new page
+    reset_html_parser(parser);
+    parser->_curl_buffer.limit = max_page_size > 0 ? max_page_size : HTML_BUFFER_DEFAULT_LIMIT;
+}
+
+/**
+ * Copy the header value if the header line is the named header.
+ * Header names are case insensitive and HTTP/2 sends them in lower case.
+ */
+static void copy_header_value(const char* line, size_t len, const char* name, char* value)
+{
+    size_t name_len = strlen(name);
+    if (len <= name_len || line[name_len] != ':')
+        return;
+
+    for (size_t i = 0; i < name_len; i++) {
+        char c = line[i];
+        if (c >= 'A' && c <= 'Z')
+            c += 'a' - 'A';
+        if (c != name[i])
+            return;
+    }
+
+    size_t start = name_len + 1;
+    while (start < len && line[start] == ' ')
+        start++;
+
+    size_t end = len;
+    while (end > start && (line[end - 1] == '\r' || line[end - 1] == '\n'))
+        end--;
+
+    size_t value_len = end - start;
+    if (value_len >= DISK_CACHE_VALIDATOR_MAX)
+        return;
+
+    memcpy(value, line + start, value_len);
+    value[value_len] = '\0';
+}
+
+/* curl header callback, collects the validators for the disk cache */
+static size_t read_validator_header(char* in, size_t size, size_t nitems, void* out)
+{
+    cache_validators* validators = (cache_validators*)out;
+    size_t len = size * nitems;
+    copy_header_value(in, len, "etag", validators->etag);
+    copy_header_value(in, len, "last-modified", validators->last_modified);
+
+    return len;
+}
+
+/**
+ * Ask the server to only send the page if it has changed since it was cached
+ */
+static struct curl_slist* conditional_headers(const cache_validators* validators)
+{
+    char header[DISK_CACHE_VALIDATOR_MAX + 32];
+    struct curl_slist* headers = NULL;
+
+    if (validators->etag[0] != '\0') {
+        snprintf(header, sizeof(header), "If-None-Match: %s", validators->etag);
+        headers = curl_slist_append(headers, header);
+    }
+
+    if (validators->last_modified[0] != '\0') {
+        snprintf(header, sizeof(header), "If-Modified-Since: %s", validators->last_modified);
+        headers = curl_slist_append(headers, header);
+    }
+
+    return headers;
+}
+
+/**
+ * Errors that mean the server couldn't be reached at all.
+ * Cached pages are only served in place of these errors.
+ */
+static bool is_network_error(CURLcode err)
+{
+    return err != CURLE_HTTP_RETURNED_ERROR && err != CURLE_ABORTED_BY_CALLBACK && err != CURLE_WRITE_ERROR;
+}
+
+static bool loader_cancelled(page_loader* loader)
+{
+    return __atomic_load_n(&loader->cancel, __ATOMIC_ACQUIRE) != 0;
+}
+
+/* curl progress callback, aborts the transfer when the load is cancelled */
+static int check_cancel(void* data, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow)
+{
+    page_loader* loader = (page_loader*)data;
+    return loader_cancelled(loader);
+}
+
+/**
+ * Set the options shared by every transfer
+ */
+static void setup_curl_handle(CURL* curl)
+{
     curl_easy_setopt(curl, CURLOPT_USERAGENT, "Yle teletext reader " TEKSTITV_STR_VERSION);
-    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, curl_errbuf);
     curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+    // Send keepalive probes so an idle connection isn't silently dropped.
+    // The connection itself is reused because the easy handle is reused.
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
     // TODO: uncomment for verbose mode
     /* curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L); */
     /* curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L); */
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_to_buffer);
+}
 
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &parser->_curl_buffer);
+bool init_tekstitv(void)
+{
+    return curl_global_init(CURL_GLOBAL_DEFAULT) == CURLE_OK;
+}
+
+void free_tekstitv(void)
+{
+    curl_global_cleanup();
+}
+
+void init_page_loader(page_loader* loader)
+{
+    CURL* curl = curl_easy_init();
+    loader->_curl = curl;
+    loader->error[0] = '\0';
+    loader->cancel = 0;
+    loader->cache_dir[0] = '\0';
+    loader->on_progress = NULL;
+    loader->progress_data = NULL;
+    loader->max_page_size = HTML_BUFFER_DEFAULT_LIMIT;
+    memcpy(loader->base_url, PAGE_LOADER_DEFAULT_BASE_URL, sizeof(PAGE_LOADER_DEFAULT_BASE_URL));
+    loader->fetch = NULL;
+    loader->fetch_data = NULL;
+
+    if (curl == NULL)
+        return;
+
+    setup_curl_handle(curl);
+    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, loader->error);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, check_cancel);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, loader);
+}
+
+void free_page_loader(page_loader* loader)
+{
+    if (loader->_curl != NULL)
+        curl_easy_cleanup(loader->_curl);
+    loader->_curl = NULL;
+}
+
+/**
+ * Store the loaded pages to the directory and revalidate them with
+ * conditional requests. NULL uses $XDG_CACHE_HOME/tekstitv or ~/.cache/tekstitv.
+ * Returns false and leaves the cache disabled if the directory can't be created.
+ */
+bool loader_use_disk_cache(page_loader* loader, const char* dir)
+{
+    char default_dir[PAGE_LOADER_PATH_MAX];
+    if (dir == NULL) {
+        if (!disk_cache_default_dir(default_dir, sizeof(default_dir)))
+            return false;
+        dir = default_dir;
+    }
+
+    size_t len = strlen(dir);
+    if (len >= PAGE_LOADER_PATH_MAX || !disk_cache_create_dir(dir))
+        return false;
+
+    memcpy(loader->cache_dir, dir, len + 1);
+    return true;
+}
+
+/**
+ * Load the pages from another url than yle.fi, like a directory
+ * (file:///path/to/pages/) or a local server. The url should end with a slash.
+ * Returns false and keeps the old url if the url is too long.
+ */
+bool loader_set_base_url(page_loader* loader, const char* url)
+{
+    size_t len = strlen(url);
+    if (len >= PAGE_LOADER_URL_MAX)
+        return false;
+
+    memcpy(loader->base_url, url, len + 1);
+    return true;
+}
+
+/**
+ * Load the pages with the callback instead of curl. NULL goes back to curl.
+ */
+void loader_use_fetch(page_loader* loader, page_fetch_callback fetch, void* data)
+{
+    loader->fetch = fetch;
+    loader->fetch_data = data;
+}
+
+/**
+ * Abort the running and the following loads of the loader, or allow
+ * loading again. Safe to call from any thread.
+ */
+void loader_set_cancel(page_loader* loader, bool cancel)
+{
+    __atomic_store_n(&loader->cancel, cancel ? 1 : 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * page_fetch_callback for the pages of a page_memory_map
+ */
+bool page_memory_fetch(const char* link, html_buffer* buffer, void* data)
+{
+    const page_memory_map* map = data;
+    if (map->latency_ms > 0) {
+        struct timespec latency;
+        latency.tv_sec = map->latency_ms / 1000;
+        latency.tv_nsec = (map->latency_ms % 1000) * 1000000L;
+        nanosleep(&latency, NULL);
+    }
+
+    for (size_t i = 0; i < map->size; i++) {
+        if (strcmp(map->pages[i].link, link) == 0)
+            return html_buffer_append(buffer, map->pages[i].html, map->pages[i].size);
+    }
+
+    return false;
+}
+
+/**
+ * Replace the loaded data with the cached page. Sections parsed from
+ * the partially loaded data are thrown away.
+ */
+static bool read_cached_page(page_loader* loader, html_parser* parser)
+{
+    reset_load_state(parser, loader->max_page_size);
+    return disk_cache_read_page(loader->cache_dir, parser->link, &parser->_curl_buffer);
+}
+
+/**
+ * Load and parse the page. Parsing is done while the page is loading,
+ * so on_progress can draw the beginning of the page early.
+ */
+void loader_load_page(page_loader* loader, html_parser* parser)
+{
+    CURL* curl = loader->_curl;
+    CURLcode err;
+    char page[PAGE_URL_SIZE];
+    page_url(page, loader->base_url, parser->link);
+    reset_load_state(parser, loader->max_page_size);
+
+    // The disk cache is only used with curl
+    if (loader->fetch != NULL && !loader_cancelled(loader)) {
+        if (!loader->fetch(parser->link, &parser->_curl_buffer, loader->fetch_data)) {
+            parser->curl_load_error = true;
+            return;
+        }
+        if (parse_html_partial(parser, false) && loader->on_progress != NULL)
+            loader->on_progress(parser, loader->progress_data);
+        parse_html(parser);
+        return;
+    }
+
+    if (curl == NULL || loader_cancelled(loader)) {
+        parser->curl_load_error = true;
+        return;
+    }
+
+    bool use_cache = loader->cache_dir[0] != '\0';
+    cache_validators cached;
+    cache_validators received = { .etag = "", .last_modified = "" };
+    bool has_cached = use_cache && disk_cache_read_validators(loader->cache_dir, parser->link, &cached);
+    struct curl_slist* headers = has_cached ? conditional_headers(&cached) : NULL;
+    page_transfer transfer = { .loader = loader, .parser = parser, .too_large = false };
+
+    // The easy handle keeps its connection cache between the transfers,
+    // so only the url and the target buffer change between the pages
+    loader->error[0] = '\0';
+    curl_easy_setopt(curl, CURLOPT_URL, page);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_and_parse);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &transfer);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    // Without the header function curl would pass the headers to the write function
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, use_cache ? read_validator_header : NULL);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, use_cache ? &received : NULL);
     err = curl_easy_perform(curl);
-    if (err)
-        // fprintf(stderr, "%s\n", curl_errbuf);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, NULL);
+    curl_slist_free_all(headers);
+
+    if (err == CURLE_WRITE_ERROR && transfer.too_large)
+        snprintf(loader->error, sizeof(loader->error), "Page is larger than the %zu byte limit", parser->_curl_buffer.limit);
+    else if (err == CURLE_WRITE_ERROR)
+        snprintf(loader->error, sizeof(loader->error), "Not enough memory to load the page");
+
+    if (err) {
+        // fprintf(stderr, "%s\n", loader->error);
+        // Show the old copy of the page when offline
+        if (has_cached && is_network_error(err) && read_cached_page(loader, parser)) {
+            parser->stale = true;
+            parse_html(parser);
+            return;
+        }
         parser->curl_load_error = true;
+        return;
+    }
+
+    if (!use_cache) {
+        parse_html(parser);
+        return;
+    }
+
+    long status = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    if (status == 304) {
+        // Page hasn't changed so the body is in the cache
+        if (!has_cached || !read_cached_page(loader, parser))
+            parser->curl_load_error = true;
+        else
+            parse_html(parser);
+        return;
+    }
+
+    disk_cache_write_page(loader->cache_dir, parser->link, &received, &parser->_curl_buffer);
+    parse_html(parser);
+}
+
+void load_page(html_parser* parser)
+{
+    page_loader loader;
+    init_page_loader(&loader);
+    loader_load_page(&loader, parser);
+    free_page_loader(&loader);
+}
+
+/**
+ * Start loading the parser with an idle easy handle
+ */
+static void add_batch_transfer(CURLM* multi, CURL* curl, html_parser* parser, page_batch_options* options)
+{
+    char page[PAGE_URL_SIZE];
+    page_url(page, options->base_url, parser->link);
+    reset_load_state(parser, options->max_page_size);
+
+    // CURLOPT_URL copies the string so the stack buffer is fine here
+    curl_easy_setopt(curl, CURLOPT_URL, page);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &parser->_curl_buffer);
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, (void*)parser);
+    curl_multi_add_handle(multi, curl);
+}
+
+void load_page_batch(page_batch_options options, char** links, html_parser* parsers, size_t count)
+{
+    if (count == 0)
+        return;
+
+    long concurrency = options.max_concurrency > 0 ? options.max_concurrency : PAGE_BATCH_MAX_CONCURRENCY;
+    long host_connections = options.max_host_connections > 0 ? options.max_host_connections : PAGE_BATCH_MAX_HOST_CONNECTIONS;
+    if ((size_t)concurrency > count)
+        concurrency = (long)count;
+
+    for (size_t i = 0; i < count; i++)
+        link_from_short_link(&parsers[i], links[i]);
+
+    if (options.base_url == NULL)
+        options.base_url = PAGE_LOADER_DEFAULT_BASE_URL;
+
+    if (options.fetch != NULL) {
+        for (size_t i = 0; i < count; i++) {
+            reset_load_state(&parsers[i], options.max_page_size);
+            if (options.fetch(parsers[i].link, &parsers[i]._curl_buffer, options.fetch_data))
+                parse_html(&parsers[i]);
+            else
+                parsers[i].curl_load_error = true;
+        }
+        return;
+    }
+
+    CURLM* multi = curl_multi_init();
+    CURL** handles = malloc(sizeof(CURL*) * concurrency);
+    if (multi == NULL || handles == NULL) {
+        for (size_t i = 0; i < count; i++)
+            parsers[i].curl_load_error = true;
+        goto cleanup;
+    }
+
+    curl_multi_setopt(multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, concurrency);
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, host_connections);
+    // Use HTTP/2 multiplexing when the server supports it
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
+    // Every easy handle is reused for the following pages, so the
+    // connections are reused just like with the page_loader
+    size_t next = 0;
+    long started = 0;
+    for (; started < concurrency; started++) {
+        handles[started] = curl_easy_init();
+        if (handles[started] == NULL)
+            break;
+        setup_curl_handle(handles[started]);
+        add_batch_transfer(multi, handles[started], &parsers[next++], &options);
+    }
+
+    // Couldn't create any handles
+    if (started == 0) {
+        for (size_t i = 0; i < count; i++)
+            parsers[i].curl_load_error = true;
+        goto cleanup;
+    }
+
+    int running = 1;
+    while (running) {
+        curl_multi_perform(multi, &running);
+
+        CURLMsg* msg;
+        int queued;
+        while ((msg = curl_multi_info_read(multi, &queued)) != NULL) {
+            if (msg->msg != CURLMSG_DONE)
+                continue;
+
+            CURL* curl = msg->easy_handle;
+            html_parser* parser;
+            curl_easy_getinfo(curl, CURLINFO_PRIVATE, (char**)&parser);
+            // The message is invalid once the handle is removed
+            CURLcode result = msg->data.result;
+            curl_multi_remove_handle(multi, curl);
+
+            // Parse the page right away while the other transfers are still running
+            if (result != CURLE_OK)
+                parser->curl_load_error = true;
+            else
+                parse_html(parser);
+
+            if (next < count) {
+                add_batch_transfer(multi, curl, &parsers[next++], &options);
+                running = 1;
+            }
+        }
+
+        if (running)
+            curl_multi_poll(multi, NULL, 0, 1000, NULL);
+    }
+
+    for (long i = 0; i < started; i++)
+        curl_easy_cleanup(handles[i]);
 
-    /* clean-up */
-    curl_easy_cleanup(curl);
+cleanup:
+    free(handles);
+    if (multi != NULL)
+        curl_multi_cleanup(multi);
 }
@@ -0,0 +1,64 @@
+#include <stdlib.h>
+#include <tekstitv.h>
+
+void init_html_parser_pool(html_parser_pool* pool)
+{
+    pool->parsers = NULL;
+    pool->size = 0;
+    pool->capacity = 0;
+}
+
+/**
+ * Free the parsers in the pool. Parsers that are still taken
+ * have to be freed with free_html_parser by their users.
+ */
+void free_html_parser_pool(html_parser_pool* pool)
+{
+    for (size_t i = 0; i < pool->size; i++) {
+        free_html_parser(pool->parsers[i]);
+        free(pool->parsers[i]);
+    }
+
+    free(pool->parsers);
+    init_html_parser_pool(pool);
+}
+
+/**
+ * Take a reset parser from the pool or create a new one.
+ * Returns NULL if a new parser can't be allocated.
+ */
+html_parser* html_parser_pool_take(html_parser_pool* pool)
+{
+    if (pool->size > 0) {
+        html_parser* parser = pool->parsers[--pool->size];
+        reset_html_parser(parser);
+        return parser;
+    }
+
+    html_parser* parser = malloc(sizeof(html_parser));
+    if (parser != NULL)
+        init_html_parser(parser);
+    return parser;
+}
+
+/**
+ * Return the parser to the pool so its memory is used for the next page
+ */
+void html_parser_pool_give(html_parser_pool* pool, html_parser* parser)
+{
+    if (pool->size == pool->capacity) {
+        size_t capacity = pool->capacity > 0 ? pool->capacity * 2 : 8;
+        html_parser** parsers = realloc(pool->parsers, capacity * sizeof(html_parser*));
+        if (parsers == NULL) {
+            // The parser can't be kept so it's just freed
+            free_html_parser(parser);
+            free(parser);
+            return;
+        }
+
+        pool->parsers = parsers;
+        pool->capacity = capacity;
+    }
+
+    pool->parsers[pool->size++] = parser;
+}
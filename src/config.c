@@ -1,3 +1,4 @@
+#define _POSIX_C_SOURCE 200809L
 
 #include <errno.h>
 #include <fcntl.h>
@@ -31,8 +32,8 @@
 
 // Example 15.09. 10:05
 #define DEFAULT_TIME_FMT "%d.%m. %H:%M"
-#define TIME_BUFFER_SIZE 256
-static char time_buffer[TIME_BUFFER_SIZE];
+#define DEFAULT_CACHE_SIZE 32
+#define DEFAULT_CACHE_TTL 300
 
 typedef struct {
     int argc;
@@ -72,10 +73,13 @@ config global_config = {
     .no_middle = false,
     .no_sub_page = false,
     .default_colors = false,
+    .no_disk_cache = false,
     .bg_rgb = { -1, -1, -1 },
     .text_rgb = { -1, -1, -1 },
     .link_rgb = { -1, -1, -1 },
-    .time_fmt = NULL
+    .time_fmt = NULL,
+    .cache_size = DEFAULT_CACHE_SIZE,
+    .cache_ttl = DEFAULT_CACHE_TTL
 };
 
 bool ignore_config_read_during_testing = false;
@@ -176,6 +180,41 @@ static void parse_color_argument(color_type color)
         color_parameter_error(false);
 }
 
+/**
+ * Parse a non negative number. Returns -1 if the string is not a valid number
+ */
+static int parse_number(const char* str, size_t len)
+{
+    if (len == 0 || len > 9)
+        return -1;
+
+    int value = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (!IS_DIGIT(str[i]))
+            return -1;
+        value = value * 10 + (str[i] - '0');
+    }
+
+    return value;
+}
+
+static void parse_number_argument(int* option)
+{
+    args.current++;
+    if (args.current >= args.argc) {
+        fprintf(stderr, "%s argument needs a number as an argument; was empty\n", PREVIOUS);
+        exit(1);
+    }
+
+    int value = parse_number(CURRENT, strlen(CURRENT));
+    if (value == -1) {
+        fprintf(stderr, "%s argument needs a number as an argument; was %s\n", PREVIOUS, CURRENT);
+        exit(1);
+    }
+
+    *option = value;
+}
+
 /**
  * random string is a optional parameter, if argument is not set
  * (no args or next one starts with '-'), the default_option is used.
@@ -250,8 +289,14 @@ static void long_option(void)
         global_config.help_config = true;
     } else if (strcmp(CURRENT, "--default-colors") == 0) {
         global_config.default_colors = true;
+    } else if (strcmp(CURRENT, "--no-disk-cache") == 0) {
+        global_config.no_disk_cache = true;
     } else if (strcmp(CURRENT, "--show-time") == 0) {
         parse_default_option((char**)&global_config.time_fmt, DEFAULT_TIME_FMT);
+    } else if (strcmp(CURRENT, "--cache-size") == 0) {
+        parse_number_argument(&global_config.cache_size);
+    } else if (strcmp(CURRENT, "--cache-ttl") == 0) {
+        parse_number_argument(&global_config.cache_ttl);
     } else if (strcmp(CURRENT, "--config") == 0) {
         // --config option is handled earlier so here we can just consume
         // the parameter and continue
@@ -346,6 +391,16 @@ fail:
     return config_parse_error("Invalid hex color parameter.");
 }
 
+static bool set_number_option(int* option, char* param, int param_len)
+{
+    int value = parse_number(param, param_len);
+    if (value == -1)
+        return config_parse_error("Invalid number parameter.");
+
+    *option = value;
+    return true;
+}
+
 /**
  * "true" | "false" | "random string"
  * true sets the option to a the default string
@@ -406,8 +461,14 @@ static bool set_config_option(config_line line)
         success = set_boolean_option(&global_config.no_sub_page, line.parameter.start, parameter_len);
     } else if (strncmp(line.option.start, "default-colors", option_len) == 0) {
         success = set_boolean_option(&global_config.default_colors, line.parameter.start, parameter_len);
+    } else if (strncmp(line.option.start, "no-disk-cache", option_len) == 0) {
+        success = set_boolean_option(&global_config.no_disk_cache, line.parameter.start, parameter_len);
     } else if (strncmp(line.option.start, "show-time", option_len) == 0) {
         success = set_default_option((char**)&global_config.time_fmt, line.parameter.start, parameter_len, DEFAULT_TIME_FMT);
+    } else if (strncmp(line.option.start, "cache-size", option_len) == 0) {
+        success = set_number_option(&global_config.cache_size, line.parameter.start, parameter_len);
+    } else if (strncmp(line.option.start, "cache-ttl", option_len) == 0) {
+        success = set_number_option(&global_config.cache_ttl, line.parameter.start, parameter_len);
     } else {
         line.option.start[option_len] = '\0';
         return config_parse_error("Unknown option: '%s'", line.option.start);
@@ -492,7 +553,8 @@ bool parse_config_file(char* file_data)
 
         line.parameter.end = last_arg_char;
 
-        if (line.parameter.start == line.parameter.end)
+        // Parameter can be a single character so check that anything was found
+        if (line.parameter.start == file_data)
             return config_parse_error("Expected parameter after '='");
 
         // Finally try to set the config option
@@ -645,21 +707,20 @@ void free_config(config* conf)
         free((char*)conf->time_fmt);
 }
 
-fmt_time current_time(void)
+fmt_time current_time(const config* conf)
 {
     fmt_time ctime;
+    ctime.time[0] = '\0';
+    ctime.time_len = 0;
 
-    if (global_config.time_fmt == NULL) {
-        ctime.time = "";
-        ctime.time_len = 0;
+    if (conf->time_fmt == NULL)
         return ctime;
-    }
 
     time_t ctimestamp = time(NULL);
-    struct tm* current_time = localtime(&ctimestamp);
-    size_t time_len = strftime(time_buffer, TIME_BUFFER_SIZE, global_config.time_fmt, current_time);
+    struct tm current_time;
+    if (localtime_r(&ctimestamp, &current_time) == NULL)
+        return ctime;
 
-    ctime.time = time_buffer;
-    ctime.time_len = time_len;
+    ctime.time_len = strftime(ctime.time, FMT_TIME_SIZE, conf->time_fmt, &current_time);
     return ctime;
 }
@@ -3,10 +3,11 @@
 
 #include <stdbool.h>
 
+#define FMT_TIME_SIZE 256
+
 /** Formated time based on the configured time format */
 typedef struct {
-    /** Time refers to a internal buffer so it should not be modified */
-    const char* time;
+    char time[FMT_TIME_SIZE];
     size_t time_len;
 } fmt_time;
 
@@ -26,20 +27,27 @@ typedef struct {
     bool no_middle;
     bool no_sub_page;
     bool default_colors;
+    bool no_disk_cache;
     short bg_rgb[3];
     short link_rgb[3];
     short text_rgb[3];
     const char* time_fmt;
+    // How many pages are kept in memory, 0 disables the cache
+    int cache_size;
+    // Seconds until a cached page is loaded again, 0 keeps pages forever
+    int cache_ttl;
 } config;
 
-#define BG_RGB(i) (global_config.bg_rgb[i])
-#define LINK_RGB(i) (global_config.link_rgb[i])
-#define TEXT_RGB(i) (global_config.text_rgb[i])
+#define BG_RGB(conf, i) ((conf)->bg_rgb[i])
+#define LINK_RGB(conf, i) ((conf)->link_rgb[i])
+#define TEXT_RGB(conf, i) ((conf)->text_rgb[i])
 
 void init_config(int argc, char** argv);
 void free_config(config* conf);
-fmt_time current_time(void);
+fmt_time current_time(const config* conf);
 
+// Filled by init_config. Only main reads it, the drawer and the printer
+// get the config as an argument.
 extern config global_config;
 // Ignores the config read from defalt path during config tests
 extern bool ignore_config_read_during_testing;
@@ -18,32 +18,22 @@
 #define LINK_COLOR_ID 2
 #define LINK_COLOR COLOR_PAIR(LINK_COLOR_ID)
 
-#define HISTORY_CAPACITY 16
-
 #define HISTORY_NEXT(val) (((val) + 1) % HISTORY_CAPACITY)
 #define HISTORY_PREV(val) (((val) + HISTORY_CAPACITY - 1) % HISTORY_CAPACITY)
-#define HISTORY_CURRENT_LINK (history.entries[history.current])
-
-typedef struct {
-    // Storage for browser links
-    char entries[HISTORY_CAPACITY][HTML_LINK_SIZE];
-    int count; // Amount of items in the buffer
-    int start; // Start of the valid data
-    int current; // Index of the value we are currently using
-} browser_history;
-
-browser_history history = {
-    .count = 0,
-    .start = 0,
-    .current = -1,
-};
-
-typedef struct {
-    char prev_page[HTML_LINK_SIZE];
-    char next_page[HTML_LINK_SIZE];
-    char prev_sub_page[HTML_LINK_SIZE];
-    char next_sub_page[HTML_LINK_SIZE];
-} navigation;
+#define HISTORY_CURRENT_LINK (history->entries[history->current])
+
+#define SWAP(type, a, b) \
+    do {                 \
+        type _swap = (a); \
+        (a) = (b);       \
+        (b) = _swap;     \
+    } while (0)
+
+// How often the load progress is updated while waiting for the network
+#define LOAD_PROGRESS_INTERVAL_MS 100
+// Keys pressed while a page loads that are handled after the load
+#define LOAD_KEY_QUEUE_SIZE 16
+#define LOAD_ERROR_INFO "Couldn't load the page, press s to search, o to return"
 
 typedef enum {
     PREV_PAGE = 0,
@@ -52,14 +42,11 @@ typedef enum {
     NEXT_SUB_PAGE
 } nav_type;
 
-static navigation nav_links;
-static link_highlight* old_link = NULL;
-
 static void search_mode(drawer* drawer, html_parser* parser);
-static void load_link(drawer* drawer, html_parser* parser, bool add_history);
 static void draw_to_info_window(drawer* drawer, const char* text);
 static int handle_getch(drawer* drawer, html_parser* parser);
 static void redraw_parser(drawer* drawer, html_parser* parser, bool init, bool add_history);
+static bool show_history_page(drawer* drawer, html_parser* parser);
 
 #ifdef DEBUG
 /**
@@ -77,84 +64,94 @@ static void draw_logger(const char* format, ...)
 }
 #endif // DEBUG_LOGGER
 
-static bool history_at_last_link(void)
+static bool history_at_last_link(browser_history* history)
 {
-    if (history.start == 0) {
-        if (history.current == history.count - 1)
+    if (history->start == 0) {
+        if (history->current == history->count - 1)
             return true;
-    } else if (history.current == history.start - 1) {
+    } else if (history->current == history->start - 1) {
         return true;
     }
 
     return false;
 }
 
-static void add_history_link(char* link)
+static void add_history_link(browser_history* history, char* link)
 {
-    bool at_last = history_at_last_link();
+    bool at_last = history_at_last_link(history);
 
     // If history is not full and we are at the last link we can just add new link
-    if (history.count != HISTORY_CAPACITY && at_last) {
-        history.count++;
-        history.current = HISTORY_NEXT(history.current);
-        memcpy(history.entries[history.current], link, HTML_LINK_SIZE);
+    if (history->count != HISTORY_CAPACITY && at_last) {
+        history->count++;
+        history->current = HISTORY_NEXT(history->current);
+        memcpy(history->entries[history->current], link, HTML_LINK_SIZE);
         return;
     }
 
     // If not at the last link, "Override" the links after current
     if (!at_last) {
         // + 2 Because there will be atleast the current with the upcoming link
-        if (history.start == 0 || history.start < history.current) {
-            history.count = history.current - history.start + 2;
+        if (history->start == 0 || history->start < history->current) {
+            history->count = history->current - history->start + 2;
         } else {
-            history.count = HISTORY_CAPACITY - (history.start - history.current) + 2;
+            history->count = HISTORY_CAPACITY - (history->start - history->current) + 2;
         }
     } else {
-        history.start = HISTORY_NEXT(history.start);
+        history->start = HISTORY_NEXT(history->start);
     }
 
-    history.current = HISTORY_NEXT(history.current);
-    memcpy(history.entries[history.current], link, HTML_LINK_SIZE);
+    history->current = HISTORY_NEXT(history->current);
+    memcpy(history->entries[history->current], link, HTML_LINK_SIZE);
 }
 
-static char* next_link(void)
+static char* next_link(browser_history* history)
 {
-    if (history.count == 0)
+    if (history->count == 0)
         return NULL;
 
-    if (history_at_last_link())
+    if (history_at_last_link(history))
         return NULL;
 
-    history.current = HISTORY_NEXT(history.current);
+    history->current = HISTORY_NEXT(history->current);
     return HISTORY_CURRENT_LINK;
 }
 
-static char* prev_link(void)
+static char* prev_link(browser_history* history)
 {
-    if (history.count == 0 || history.current == history.start)
+    if (history->count == 0 || history->current == history->start)
         return NULL;
 
-    history.current = HISTORY_PREV(history.current);
+    history->current = HISTORY_PREV(history->current);
     return HISTORY_CURRENT_LINK;
 }
 
-static void load_next_link(drawer* drawer, html_parser* parser)
+void load_next_link(drawer* drawer, html_parser* parser)
 {
-    char* link = next_link();
+    int current = drawer->history.current;
+    char* link = next_link(&drawer->history);
     // TODO: let user know that there is no next link
     if (link != NULL) {
+        if (show_history_page(drawer, parser))
+            return;
         link_from_short_link(parser, link);
-        load_link(drawer, parser, false);
+        // Cancelled load keeps the current page
+        if (!load_link(drawer, parser, false))
+            drawer->history.current = current;
     }
 }
 
-static void load_prev_link(drawer* drawer, html_parser* parser)
+void load_prev_link(drawer* drawer, html_parser* parser)
 {
-    char* link = prev_link();
+    int current = drawer->history.current;
+    char* link = prev_link(&drawer->history);
     // TODO: let user know that there is no previous link
     if (link != NULL) {
+        if (show_history_page(drawer, parser))
+            return;
         link_from_short_link(parser, link);
-        load_link(drawer, parser, false);
+        // Cancelled load keeps the current page
+        if (!load_link(drawer, parser, false))
+            drawer->history.current = current;
     }
 }
 
@@ -186,11 +183,11 @@ static void curl_load_error(drawer* drawer, html_parser* parser)
 {
     // Kind of a hack to get history working with load errors
     if (!drawer->error_drawn) {
-        history.current = HISTORY_NEXT(history.current);
+        drawer->history.current = HISTORY_NEXT(drawer->history.current);
         drawer->error_drawn = true;
     }
 
-    draw_to_info_window(drawer, "Couldn't load the page, press s to search, o to return");
+    draw_to_info_window(drawer, LOAD_ERROR_INFO);
     for (;;) {
         char c = handle_getch(drawer, parser);
         if (c == 's') {
@@ -228,9 +225,11 @@ static void set_main_window_size(drawer* drawer)
     drawer->highlight_col = -1;
     drawer->highlight_row_size = 0;
     drawer->error_drawn = false;
+    // New window is empty
+    drawer->shown_invalid = true;
     drawer->window = newwin(drawer->w_height, drawer->w_width, drawer->window_start_y, drawer->window_start_x);
 
-    if (drawer->color_support && !global_config.default_colors) {
+    if (drawer->color_support && !drawer->config->default_colors) {
         use_default_colors();
         start_color();
         // Link color is by default the default blue
@@ -238,15 +237,15 @@ static void set_main_window_size(drawer* drawer)
         drawer->link_color = COLOR_BLUE;
         // Redefine the colors if user has set them
         if (can_change_color()) {
-            if (BG_RGB(0) != -1) {
+            if (BG_RGB(drawer->config, 0) != -1) {
                 drawer->background_color = COLOR_BLACK;
-                init_color(COLOR_BLACK, BG_RGB(0), BG_RGB(1), BG_RGB(2));
+                init_color(COLOR_BLACK, BG_RGB(drawer->config, 0), BG_RGB(drawer->config, 1), BG_RGB(drawer->config, 2));
             }
-            if (LINK_RGB(0) != -1)
-                init_color(COLOR_BLUE, LINK_RGB(0), LINK_RGB(1), LINK_RGB(2));
-            if (TEXT_RGB(0) != -1) {
+            if (LINK_RGB(drawer->config, 0) != -1)
+                init_color(COLOR_BLUE, LINK_RGB(drawer->config, 0), LINK_RGB(drawer->config, 1), LINK_RGB(drawer->config, 2));
+            if (TEXT_RGB(drawer->config, 0) != -1) {
                 drawer->text_color = COLOR_WHITE;
-                init_color(COLOR_WHITE, TEXT_RGB(0), TEXT_RGB(1), TEXT_RGB(2));
+                init_color(COLOR_WHITE, TEXT_RGB(drawer->config, 0), TEXT_RGB(drawer->config, 1), TEXT_RGB(drawer->config, 2));
             }
         }
         init_pair(TEXT_COLOR_ID, drawer->text_color, drawer->background_color);
@@ -259,22 +258,107 @@ static void set_main_window_size(drawer* drawer)
     refresh();
 }
 
-static bool find_link_highlight(drawer* drawer, int x, int y, char* link_target)
+/**
+ * Highlightable link in the row and column, or NULL if there is no such link
+ */
+static link_highlight* highlight_link(drawer* drawer, int row, int col)
 {
-    int hrows = drawer->highlight_row_size;
-    link_highlight_row* lrows = drawer->highlight_rows;
-    for (int i = 0; i < hrows; i++) {
-        for (int j = 0; j < lrows[i].size; j++) {
-            link_highlight link = lrows[i].links[j];
-            bool match_y = y - drawer->window_start_y == link.start_y;
-            int adjustx = x - drawer->window_start_x;
-            if (match_y && adjustx >= link.start_x && adjustx <= link.start_x + (int)strlen(html_link_text(link.link))) {
-                strcpy(link_target, html_link_link(link.link));
-                return true;
-            }
-        }
+    if (row < 0 || row >= drawer->highlight_row_size)
+        return NULL;
+    if (col < 0 || col >= drawer->highlight_rows[row].size)
+        return NULL;
+
+    return &drawer->highlight_links[drawer->highlight_rows[row].first + col];
+}
+
+/**
+ * Forget the highlights of the previous page before drawing a new one
+ */
+static void clear_link_highlights(drawer* drawer)
+{
+    drawer->highlight_row_size = 0;
+    drawer->highlight_links_size = 0;
+    if (drawer->highlight_rows != NULL)
+        memset(drawer->highlight_rows, 0, sizeof(link_highlight_row) * drawer->highlight_rows_capacity);
+    // Old link points to the memory of the previous page
+    drawer->old_link = NULL;
+
+    // Window size may have changed since the last page
+    int cells = drawer->w_width * drawer->w_height;
+    if (cells > drawer->link_grid_capacity) {
+        int* grid = realloc(drawer->link_grid, sizeof(int) * cells);
+        if (grid == NULL)
+            return;
+        drawer->link_grid = grid;
+        drawer->link_grid_capacity = cells;
+    }
+    if (drawer->link_grid != NULL)
+        memset(drawer->link_grid, 0, sizeof(int) * drawer->link_grid_capacity);
+}
+
+/**
+ * Mark the cells of the link to the link grid
+ */
+static void add_link_grid_cells(drawer* drawer, const link_highlight* link, int index)
+{
+    int cells = drawer->w_width * drawer->w_height;
+    if (drawer->link_grid == NULL || cells > drawer->link_grid_capacity)
+        return;
+    if (link->start_y < 0 || link->start_y >= drawer->w_height)
+        return;
+
+    int* row = drawer->link_grid + link->start_y * drawer->w_width;
+    for (int x = link->start_x; x < link->start_x + link->width; x++) {
+        if (x >= 0 && x < drawer->w_width)
+            row[x] = index + 1;
     }
-    return false;
+}
+
+/**
+ * Make sure the row that is currently filled exists
+ */
+static bool reserve_highlight_row(drawer* drawer)
+{
+    if (drawer->highlight_row_size < drawer->highlight_rows_capacity)
+        return true;
+
+    int capacity = drawer->highlight_rows_capacity > 0 ? drawer->highlight_rows_capacity * 2 : 32;
+    link_highlight_row* rows = realloc(drawer->highlight_rows, sizeof(link_highlight_row) * capacity);
+    if (rows == NULL)
+        return false;
+
+    memset(rows + drawer->highlight_rows_capacity, 0, sizeof(link_highlight_row) * (capacity - drawer->highlight_rows_capacity));
+    drawer->highlight_rows = rows;
+    drawer->highlight_rows_capacity = capacity;
+    return true;
+}
+
+/**
+ * Finish the row that is currently filled, if it has room
+ */
+static void next_highlight_row(drawer* drawer)
+{
+    if (reserve_highlight_row(drawer))
+        drawer->highlight_row_size++;
+}
+
+/**
+ * Link in the screen position, or NULL if no link was drawn there
+ */
+static link_highlight* find_link_highlight(drawer* drawer, int x, int y)
+{
+    int window_x = x - drawer->window_start_x;
+    int window_y = y - drawer->window_start_y;
+    if (window_x < 0 || window_x >= drawer->w_width || window_y < 0 || window_y >= drawer->w_height)
+        return NULL;
+    if (drawer->link_grid == NULL || drawer->w_width * drawer->w_height > drawer->link_grid_capacity)
+        return NULL;
+
+    int index = drawer->link_grid[window_y * drawer->w_width + window_x] - 1;
+    if (index < 0 || index >= drawer->highlight_links_size)
+        return NULL;
+
+    return &drawer->highlight_links[index];
 }
 
 /**
@@ -292,71 +376,231 @@ static int handle_getch(drawer* drawer, html_parser* parser)
     return c;
 }
 
+static void free_display_list(display_list* list)
+{
+    free(list->runs);
+    free(list->text);
+    memset(list, 0, sizeof(display_list));
+}
+
 /**
- * Find how many uft characters are found in the text.
- *
- * Utf-8 characters used in tekstitv are always 2 bytes but are displayed
- * as one character. This cofuses the drawer->curret_x counter since it
- * counts every byte as a displayed character.
- * Workaround for this is just to find all the utfs used and remove the extra
- * spaces from drawer->current_x.
- *
- * // TODO: combine this with escape_text or find otherwise smarter way to do this
+ * Make room for the runs and the text. Returns false if there's not enough memory.
  */
-static int find_utfs(const char* src, size_t src_len)
+static bool reserve_display_list(display_list* list, int runs, size_t text)
 {
-    int utfs = 0;
-    for (size_t i = 0; i < src_len; i++) {
-        if ((uint8_t)src[i] == 0xc3 || (uint8_t)src[i] == 0xc2)
-            utfs++;
+    if (runs > list->capacity) {
+        int capacity = list->capacity > 0 ? list->capacity : 128;
+        while (capacity < runs)
+            capacity *= 2;
+        display_run* new_runs = realloc(list->runs, sizeof(display_run) * capacity);
+        if (new_runs == NULL)
+            return false;
+        list->runs = new_runs;
+        list->capacity = capacity;
+    }
+
+    if (text > list->text_capacity) {
+        size_t capacity = list->text_capacity > 0 ? list->text_capacity : 4096;
+        while (capacity < text)
+            capacity *= 2;
+        char* new_text = realloc(list->text, capacity);
+        if (new_text == NULL)
+            return false;
+        list->text = new_text;
+        list->text_capacity = capacity;
     }
-    return utfs;
+
+    return true;
 }
 
-static void draw_to_drawer(drawer* drawer, const char* text)
+/**
+ * Add the text to the current position of the frame. The caller moves
+ * drawer->current_x by the width of the text, the parser has measured it already.
+ */
+static void add_display_run(drawer* drawer, display_style style, const char* text, size_t size, size_t width)
+{
+    display_list* frame = &drawer->frame;
+    if (!reserve_display_list(frame, frame->size + 1, frame->text_size + size + 1))
+        return;
+
+    if (drawer->current_x + (int)width > drawer->w_width)
+        frame->overflow = true;
+
+    display_run* run = &frame->runs[frame->size++];
+    run->x = drawer->current_x;
+    run->y = drawer->current_y;
+    run->width = (int)width;
+    run->style = style;
+    run->text = frame->text_size;
+    run->size = size;
+    memcpy(frame->text + frame->text_size, text, size);
+    frame->text[frame->text_size + size] = '\0';
+    frame->text_size += size + 1;
+}
+
+static void draw_to_drawer(drawer* drawer, const html_text* text)
+{
+    add_display_run(drawer, DISPLAY_TEXT, text->text, text->size, text->width);
+}
+
+/**
+ * Draw ascii text that is not from the page, like the separators
+ */
+static void draw_separator(drawer* drawer, const char* text, size_t size)
 {
-    int utfs = find_utfs(text, strlen(text));
-    mvwprintw(drawer->window, drawer->current_y, drawer->current_x, "%s", text);
-    drawer->current_x -= utfs;
+    add_display_run(drawer, DISPLAY_TEXT, text, size, size);
 }
 
-static void draw_link_item(drawer* drawer, html_link link)
+static void draw_link_item(drawer* drawer, const html_link* link)
 {
     bool highlight = false;
     if (!drawer->init_highlight_rows) {
-        link_highlight hlight = drawer->highlight_rows[drawer->highlight_row].links[drawer->highlight_col];
-        highlight = hlight.start_x == drawer->current_x && hlight.start_y == drawer->current_y;
+        link_highlight* hlight = highlight_link(drawer, drawer->highlight_row, drawer->highlight_col);
+        highlight = hlight != NULL && hlight->start_x == drawer->current_x && hlight->start_y == drawer->current_y;
     }
 
-    if (drawer->color_support) {
-        wattron(drawer->window, LINK_COLOR);
-        if (highlight)
-            wattron(drawer->window, A_REVERSE);
+    display_style style = highlight ? DISPLAY_HIGHLIGHT : DISPLAY_LINK;
+    add_display_run(drawer, style, link->inner_text.text, link->inner_text.size, link->inner_text.width);
+}
+
+static void draw_run(drawer* drawer, const display_list* list, const display_run* run)
+{
+    attr_t attrs = 0;
+    if (drawer->color_support && run->style != DISPLAY_TEXT)
+        attrs = run->style == DISPLAY_HIGHLIGHT ? LINK_COLOR | A_REVERSE : LINK_COLOR;
+
+    if (attrs != 0)
+        wattron(drawer->window, attrs);
+    mvwprintw(drawer->window, run->y, run->x, "%s", list->text + run->text);
+    if (attrs != 0)
+        wattroff(drawer->window, attrs);
+}
+
+static bool same_run(const display_list* a, const display_run* run_a, const display_list* b, const display_run* run_b)
+{
+    return run_a->x == run_b->x && run_a->width == run_b->width && run_a->style == run_b->style
+        && run_a->size == run_b->size && memcmp(a->text + run_a->text, b->text + run_b->text, run_a->size) == 0;
+}
+
+/**
+ * Draw the frame over what is shown. Rows that haven't changed are skipped,
+ * and when the runs of a row are in the same places only the changed runs
+ * are drawn. ncurses sends only the changed cells to the terminal, so a new
+ * highlight or a similar page costs a few bytes over a slow connection.
+ */
+static void render_frame(drawer* drawer)
+{
+    display_list* frame = &drawer->frame;
+    display_list* shown = &drawer->shown;
+    // Wrapped runs change the rows below them, so compare against an empty window
+    if (drawer->shown_invalid || frame->overflow || shown->overflow) {
+        werase(drawer->window);
+        shown->size = 0;
+        shown->text_size = 0;
     }
 
-    draw_to_drawer(drawer, html_link_text(link));
+    int f = 0;
+    int s = 0;
+    while (f < frame->size || s < shown->size) {
+        int y;
+        if (f == frame->size)
+            y = shown->runs[s].y;
+        else if (s == shown->size)
+            y = frame->runs[f].y;
+        else
+            y = frame->runs[f].y < shown->runs[s].y ? frame->runs[f].y : shown->runs[s].y;
+
+        int f_end = f;
+        int s_end = s;
+        while (f_end < frame->size && frame->runs[f_end].y == y)
+            f_end++;
+        while (s_end < shown->size && shown->runs[s_end].y == y)
+            s_end++;
+
+        // Rows below the window are not drawn
+        if (y < 0 || y >= drawer->w_height) {
+            f = f_end;
+            s = s_end;
+            continue;
+        }
+
+        // Runs in the same places with the same widths can be drawn over the old ones
+        bool same_layout = f_end - f == s_end - s;
+        for (int i = 0; same_layout && i < f_end - f; i++) {
+            same_layout = frame->runs[f + i].x == shown->runs[s + i].x
+                && frame->runs[f + i].width == shown->runs[s + i].width;
+        }
+
+        if (same_layout) {
+            for (int i = 0; i < f_end - f; i++) {
+                if (!same_run(frame, &frame->runs[f + i], shown, &shown->runs[s + i]))
+                    draw_run(drawer, frame, &frame->runs[f + i]);
+            }
+        } else {
+            wmove(drawer->window, y, 0);
+            wclrtoeol(drawer->window);
+            for (int i = f; i < f_end; i++)
+                draw_run(drawer, frame, &frame->runs[i]);
+        }
+
+        f = f_end;
+        s = s_end;
+    }
 
-    if (drawer->color_support) {
-        wattroff(drawer->window, LINK_COLOR);
-        if (highlight)
-            wattroff(drawer->window, A_REVERSE);
+    // Next frame is compared to this one
+    drawer->shown_invalid = !reserve_display_list(shown, frame->size, frame->text_size);
+    if (!drawer->shown_invalid) {
+        memcpy(shown->runs, frame->runs, sizeof(display_run) * frame->size);
+        memcpy(shown->text, frame->text, frame->text_size);
+        shown->size = frame->size;
+        shown->text_size = frame->text_size;
+        shown->overflow = frame->overflow;
     }
+    wrefresh(drawer->window);
+}
+
+/**
+ * Start a new frame from the top of the window
+ */
+static void reset_frame(drawer* drawer)
+{
+    drawer->current_x = 0;
+    drawer->current_y = 0;
+    drawer->frame.size = 0;
+    drawer->frame.text_size = 0;
+    drawer->frame.overflow = false;
 }
 
-static void add_link_highlight(drawer* drawer, html_link link)
+static void add_link_highlight(drawer* drawer, const html_link* link)
 {
     if (!drawer->init_highlight_rows)
         return;
 
     link_highlight h;
-    strncpy(html_link_link(h.link), link.url.text, HTML_LINK_SIZE);
-    html_link_link(h.link)[HTML_LINK_SIZE] = '\0';
-    strncpy(html_link_text(h.link), link.inner_text.text, link.inner_text.size);
-    html_link_text(h.link)[link.inner_text.size] = '\0';
+    h.link = link;
     h.start_x = drawer->current_x;
     h.start_y = drawer->current_y;
+    h.width = (int)html_link_text_width(*link);
+    // draw_link_item added the run just before
+    h.run = drawer->frame.size - 1;
+
+    if (!reserve_highlight_row(drawer))
+        return;
+
+    if (drawer->highlight_links_size == drawer->highlight_links_capacity) {
+        int capacity = drawer->highlight_links_capacity > 0 ? drawer->highlight_links_capacity * 2 : 64;
+        link_highlight* links = realloc(drawer->highlight_links, sizeof(link_highlight) * capacity);
+        if (links == NULL)
+            return;
+        drawer->highlight_links = links;
+        drawer->highlight_links_capacity = capacity;
+    }
+
     link_highlight_row* row = &drawer->highlight_rows[drawer->highlight_row_size];
-    row->links[row->size] = h;
+    if (row->size == 0)
+        row->first = drawer->highlight_links_size;
+    add_link_grid_cells(drawer, &h, drawer->highlight_links_size);
+    drawer->highlight_links[drawer->highlight_links_size++] = h;
     row->size++;
 }
 
@@ -366,41 +610,50 @@ static void add_link_highlight(drawer* drawer, html_link link)
  */
 static void draw_to_info_window(drawer* drawer, const char* text)
 {
-    wclear(drawer->info_window);
+    werase(drawer->info_window);
     mvwprintw(drawer->info_window, 0, 0, "%s", text);
     wrefresh(drawer->info_window);
 }
 
+static void draw_page_info(drawer* drawer, html_parser* parser)
+{
+    if (parser->stale)
+        draw_to_info_window(drawer, "Offline, showing a cached page. Press q to exit, s to search");
+    else
+        draw_to_info_window(drawer, "Press q to exit, s to search");
+}
+
 /**
  * Draw title and current time
  */
 static void draw_title(drawer* drawer, html_parser* parser)
 {
-    bool draw_title = !global_config.no_title;
-    bool draw_time = global_config.time_fmt != NULL;
+    bool draw_title = !drawer->config->no_title;
+    bool draw_time = drawer->config->time_fmt != NULL;
 
     if (!draw_title && !draw_time)
         return;
 
-    fmt_time ctime = current_time();
+    fmt_time ctime = current_time(drawer->config);
 
     size_t text_len = 0;
     if (draw_title)
-        text_len += parser->title.size;
+        text_len += parser->title.width;
 
+    // Localized times can contain UTF-8 characters
     if (draw_time)
-        text_len += ctime.time_len;
+        text_len += utf8_text_width(ctime.time, ctime.time_len);
 
     drawer->current_x = centerx(text_len);
     drawer->current_y++;
 
     if (draw_title) {
-        draw_to_drawer(drawer, parser->title.text);
-        drawer->current_x += parser->title.size + 1;
+        draw_to_drawer(drawer, &parser->title);
+        drawer->current_x += parser->title.width + 1;
     }
 
     if (draw_time)
-        draw_to_drawer(drawer, ctime.time);
+        add_display_run(drawer, DISPLAY_TEXT, ctime.time, ctime.time_len, utf8_text_width(ctime.time, ctime.time_len));
 }
 
 static void draw_top_navigation(drawer* drawer, html_parser* parser)
@@ -414,34 +667,34 @@ static void draw_top_navigation(drawer* drawer, html_parser* parser)
         switch (i) {
         case 0:
             if (items[i].type == HTML_LINK)
-                strncpy(nav_links.prev_page, html_link_link(html_item_as_link(items[i])), HTML_LINK_SIZE);
+                strncpy(drawer->nav_links.prev_page, html_link_link(html_item_as_link(items[i])), HTML_LINK_SIZE);
             else
-                nav_links.prev_page[0] = 0;
+                drawer->nav_links.prev_page[0] = 0;
             break;
         case 1:
             if (items[i].type == HTML_LINK)
-                strncpy(nav_links.prev_sub_page, html_link_link(html_item_as_link(items[i])), HTML_LINK_SIZE);
+                strncpy(drawer->nav_links.prev_sub_page, html_link_link(html_item_as_link(items[i])), HTML_LINK_SIZE);
             else
-                nav_links.prev_sub_page[0] = 0;
+                drawer->nav_links.prev_sub_page[0] = 0;
             break;
         case 2:
             if (items[i].type == HTML_LINK)
-                strncpy(nav_links.next_sub_page, html_link_link(html_item_as_link(items[i])), HTML_LINK_SIZE);
+                strncpy(drawer->nav_links.next_sub_page, html_link_link(html_item_as_link(items[i])), HTML_LINK_SIZE);
             else
-                nav_links.next_sub_page[0] = 0;
+                drawer->nav_links.next_sub_page[0] = 0;
             break;
         case 3:
             if (items[i].type == HTML_LINK)
-                strncpy(nav_links.next_page, html_link_link(html_item_as_link(items[i])), HTML_LINK_SIZE);
+                strncpy(drawer->nav_links.next_page, html_link_link(html_item_as_link(items[i])), HTML_LINK_SIZE);
             else
-                nav_links.next_page[0] = 0;
+                drawer->nav_links.next_page[0] = 0;
             break;
         default:
             break;
         }
     }
 
-    if (global_config.no_nav || global_config.no_top_nav)
+    if (drawer->config->no_nav || drawer->config->no_top_nav)
         return;
 
     // Only draw navigation on "big" terminals
@@ -451,7 +704,7 @@ static void draw_top_navigation(drawer* drawer, html_parser* parser)
     // Start length with adding sizes of " | " separators
     size_t links_len = (TOP_NAVIGATION_SIZE - 1) * 3;
     for (size_t i = 0; i < TOP_NAVIGATION_SIZE; i++) {
-        links_len += html_item_text_size(items[i]);
+        links_len += html_item_text_width(items[i]);
     }
 
     // Draw navigation
@@ -459,28 +712,28 @@ static void draw_top_navigation(drawer* drawer, html_parser* parser)
     drawer->current_x = (int)centerx(links_len);
     for (size_t i = 0; i < TOP_NAVIGATION_SIZE; i++) {
         if (items[i].type == HTML_LINK) {
-            draw_link_item(drawer, html_item_as_link(items[i]));
-            add_link_highlight(drawer, html_item_as_link(items[i]));
+            draw_link_item(drawer, &html_item_as_link(items[i]));
+            add_link_highlight(drawer, &html_item_as_link(items[i]));
         } else {
-            draw_to_drawer(drawer, html_text_text(html_item_as_text(items[i])));
+            draw_to_drawer(drawer, &html_item_as_text(items[i]));
         }
 
-        drawer->current_x += html_item_text_size(items[i]);
+        drawer->current_x += html_item_text_width(items[i]);
         if (i < TOP_NAVIGATION_SIZE - 1) {
-            draw_to_drawer(drawer, " |");
+            draw_separator(drawer, " |", 2);
             drawer->current_x += 3;
         }
     }
 
     drawer->current_y += 1;
     if (drawer->init_highlight_rows) {
-        drawer->highlight_row_size++;
+        next_highlight_row(drawer);
     }
 }
 
 static void draw_bottom_navigation(drawer* drawer, html_parser* parser)
 {
-    if (global_config.no_nav || global_config.no_bottom_nav)
+    if (drawer->config->no_nav || drawer->config->no_bottom_nav)
         return;
 
     // Only draw navigation on "big" terminals
@@ -497,54 +750,54 @@ static void draw_bottom_navigation(drawer* drawer, html_parser* parser)
     // Start length with adding sizes of " | " separators
     size_t links_len = (BOTTOM_NAVIGATION_SIZE - 1) * 3;
     for (size_t i = 0; i < BOTTOM_NAVIGATION_SIZE; i++) {
-        links_len += html_link_text_size(links[i]);
+        links_len += html_link_text_width(links[i]);
     }
 
     // Draw second navigation row
     drawer->current_y += 1;
     drawer->current_x = (int)centerx(links_len);
     for (size_t i = 0; i < BOTTOM_NAVIGATION_SIZE; i++) {
-        draw_link_item(drawer, links[i]);
-        add_link_highlight(drawer, links[i]);
-        drawer->current_x += html_link_text_size(links[i]);
+        draw_link_item(drawer, &links[i]);
+        add_link_highlight(drawer, &links[i]);
+        drawer->current_x += html_link_text_width(links[i]);
         if (i < BOTTOM_NAVIGATION_SIZE - 1) {
-            draw_to_drawer(drawer, " |");
+            draw_separator(drawer, " |", 2);
             drawer->current_x += 3;
         }
     }
 
     if (drawer->init_highlight_rows)
-        drawer->highlight_row_size++;
+        next_highlight_row(drawer);
 }
 
 static void draw_sub_pages(drawer* drawer, html_parser* parser)
 {
-    if (global_config.no_sub_page)
+    if (drawer->config->no_sub_page)
         return;
 
     drawer->current_x = middle_startx();
     drawer->current_y++;
     bool link_on_row = false;
     for (size_t i = 0; i < parser->sub_pages.size; i++) {
-        html_item item = parser->sub_pages.items[i];
-        if (item.type == HTML_LINK) {
-            draw_link_item(drawer, html_item_as_link(item));
-            add_link_highlight(drawer, html_item_as_link(item));
+        html_item* item = &parser->sub_pages.items[i];
+        if (item->type == HTML_LINK) {
+            draw_link_item(drawer, &html_item_as_link(*item));
+            add_link_highlight(drawer, &html_item_as_link(*item));
             link_on_row = true;
-            drawer->current_x += html_link_text_size(html_item_as_link(item));
-        } else if (item.type == HTML_TEXT) {
-            draw_to_drawer(drawer, html_text_text(html_item_as_text(item)));
-            drawer->current_x += html_text_text_size(html_item_as_text(item));
+            drawer->current_x += html_link_text_width(html_item_as_link(*item));
+        } else if (item->type == HTML_TEXT) {
+            draw_to_drawer(drawer, &html_item_as_text(*item));
+            drawer->current_x += html_text_text_width(html_item_as_text(*item));
         }
     }
 
     if (drawer->init_highlight_rows && link_on_row)
-        drawer->highlight_row_size++;
+        next_highlight_row(drawer);
 }
 
 static void draw_middle(drawer* drawer, html_parser* parser)
 {
-    if (global_config.no_middle)
+    if (drawer->config->no_middle)
         return;
 
     html_item_type last_type = HTML_TEXT;
@@ -554,32 +807,61 @@ static void draw_middle(drawer* drawer, html_parser* parser)
         drawer->current_y++;
         bool link_on_row = false;
         for (size_t j = 0; j < parser->middle[i].size; j++) {
-            html_item item = parser->middle[i].items[j];
-            if (item.type == HTML_LINK) {
+            html_item* item = &parser->middle[i].items[j];
+            if (item->type == HTML_LINK) {
                 if (last_type == HTML_LINK) {
                     // drawer->current_x -= 1;
-                    draw_to_drawer(drawer, "-");
+                    draw_separator(drawer, "-", 1);
                     drawer->current_x += 1;
                 }
-                draw_link_item(drawer, html_item_as_link(item));
-                add_link_highlight(drawer, html_item_as_link(item));
+                draw_link_item(drawer, &html_item_as_link(*item));
+                add_link_highlight(drawer, &html_item_as_link(*item));
                 link_on_row = true;
-                drawer->current_x += html_link_text_size(html_item_as_link(item));
+                drawer->current_x += html_link_text_width(html_item_as_link(*item));
                 last_type = HTML_LINK;
-            } else if (item.type == HTML_TEXT) {
-                draw_to_drawer(drawer, html_text_text(html_item_as_text(item)));
-                drawer->current_x += html_text_text_size(html_item_as_text(item));
+            } else if (item->type == HTML_TEXT) {
+                draw_to_drawer(drawer, &html_item_as_text(*item));
+                drawer->current_x += html_text_text_width(html_item_as_text(*item));
                 last_type = HTML_TEXT;
             }
         }
 
         if (drawer->init_highlight_rows && link_on_row)
-            drawer->highlight_row_size++;
+            next_highlight_row(drawer);
     }
 }
 
 /**
- * Update link highlights without drawing the whole window
+ * Start loading the pages that are most likely opened next
+ */
+static void prefetch_neighbours(drawer* drawer)
+{
+    char* links[PREFETCH_LINKS];
+    size_t count = 0;
+
+    char* nav[] = { drawer->nav_links.next_page, drawer->nav_links.next_sub_page, drawer->nav_links.prev_page, drawer->nav_links.prev_sub_page };
+    for (size_t i = 0; i < sizeof(nav) / sizeof(nav[0]); i++) {
+        if (nav[i][0] != 0 && !page_cache_contains(&drawer->cache, nav[i]))
+            links[count++] = nav[i];
+    }
+
+    link_highlight* link = highlight_link(drawer, drawer->highlight_row, drawer->highlight_col);
+    if (link != NULL) {
+        if (!page_cache_contains(&drawer->cache, html_link_link(*link->link)))
+            links[count++] = (char*)html_link_link(*link->link);
+    }
+
+    prefetch_links(&drawer->prefetch, links, count);
+}
+
+static void set_run_style(drawer* drawer, const link_highlight* link, display_style style)
+{
+    if (link->run >= 0 && link->run < drawer->frame.size)
+        drawer->frame.runs[link->run].style = style;
+}
+
+/**
+ * Update link highlights without laying out the whole page again
  */
 static void update_link_highlights(drawer* drawer)
 {
@@ -587,56 +869,241 @@ static void update_link_highlights(drawer* drawer)
     // so set this to false so highlighting works in draw_link_item
     drawer->init_highlight_rows = false;
 
-    link_highlight* new_link = &drawer->highlight_rows[drawer->highlight_row].links[drawer->highlight_col];
-    drawer->current_x = new_link->start_x;
-    drawer->current_y = new_link->start_y;
-    draw_link_item(drawer, new_link->link);
+    link_highlight* new_link = highlight_link(drawer, drawer->highlight_row, drawer->highlight_col);
+    if (drawer->old_link != NULL)
+        set_run_style(drawer, drawer->old_link, DISPLAY_LINK);
+    if (new_link != NULL)
+        set_run_style(drawer, new_link, DISPLAY_HIGHLIGHT);
 
-    if (old_link != NULL) {
-        drawer->current_x = old_link->start_x;
-        drawer->current_y = old_link->start_y;
-        draw_link_item(drawer, old_link->link);
-    }
-
-    old_link = new_link;
-    wrefresh(drawer->window);
+    drawer->old_link = new_link;
+    render_frame(drawer);
+    prefetch_neighbours(drawer);
 }
 
-static void redraw_parser(drawer* drawer, html_parser* parser, bool init, bool add_history)
+/**
+ * Highlight the link in the row and column.
+ */
+void draw_highlight(drawer* drawer, int row, int col)
 {
-    if (parser->curl_load_error) {
-        curl_load_error(drawer, parser);
-        return;
-    }
-
-    if (add_history)
-        add_history_link(parser->link);
+    drawer->highlight_row = row;
+    drawer->highlight_col = col;
+    update_link_highlights(drawer);
+}
 
-    drawer->current_x = 0;
-    drawer->current_y = 0;
+/**
+ * Draw the whole loaded page without waiting for input.
+ * init resets the link highlights for a new page.
+ */
+void draw_page(drawer* drawer, html_parser* parser, bool init)
+{
+    reset_frame(drawer);
     drawer->error_drawn = false;
+    drawer->preview_drawn = false;
     drawer->init_highlight_rows = init;
     if (init) {
         // row and col needs to be -1 so it becomes + after +1
         drawer->highlight_row = -1;
         drawer->highlight_col = -1;
-        drawer->highlight_row_size = 0;
-        memset(drawer->highlight_rows, 0, sizeof(link_highlight_row) * 32);
+        clear_link_highlights(drawer);
     }
 
-    wclear(drawer->window);
-    draw_to_info_window(drawer, "Press q to exit, s to search");
+    draw_page_info(drawer, parser);
     draw_title(drawer, parser);
     draw_top_navigation(drawer, parser);
     draw_middle(drawer, parser);
     draw_sub_pages(drawer, parser);
     draw_bottom_navigation(drawer, parser);
-    wrefresh(drawer->window);
+    render_frame(drawer);
+}
+
+static void redraw_parser(drawer* drawer, html_parser* parser, bool init, bool add_history)
+{
+    memcpy(drawer->page_link, parser->link, HTML_LINK_SIZE + 1);
+    if (parser->curl_load_error) {
+        // Load error pages are not kept with the history
+        drawer->page_index = -1;
+        curl_load_error(drawer, parser);
+        return;
+    }
+
+    if (add_history)
+        add_history_link(&drawer->history, parser->link);
+    drawer->page_index = drawer->history.current;
+
+    draw_page(drawer, parser, init);
+    prefetch_neighbours(drawer);
+}
+
+/**
+ * Exchange the page in the parser and its layout with the history page.
+ * The parser keeps parsing the same sections.
+ */
+static void swap_history_page(drawer* drawer, html_parser* parser, history_page* page)
+{
+    unsigned sections = parser->sections;
+    SWAP(html_parser, *parser, page->parser);
+    parser->sections = sections;
+
+    SWAP(display_list, drawer->frame, page->frame);
+    SWAP(link_highlight_row*, drawer->highlight_rows, page->highlight_rows);
+    SWAP(int, drawer->highlight_rows_capacity, page->highlight_rows_capacity);
+    SWAP(int, drawer->highlight_row_size, page->highlight_row_size);
+    SWAP(link_highlight*, drawer->highlight_links, page->highlight_links);
+    SWAP(int, drawer->highlight_links_size, page->highlight_links_size);
+    SWAP(int, drawer->highlight_links_capacity, page->highlight_links_capacity);
+    SWAP(int*, drawer->link_grid, page->link_grid);
+    SWAP(int, drawer->link_grid_capacity, page->link_grid_capacity);
+    SWAP(int, drawer->highlight_row, page->highlight_row);
+    SWAP(int, drawer->highlight_col, page->highlight_col);
+    SWAP(link_highlight*, drawer->old_link, page->old_link);
+    SWAP(navigation, drawer->nav_links, page->nav_links);
+}
+
+static void free_history_page(history_page* page)
+{
+    free_html_parser(&page->parser);
+    init_html_parser(&page->parser);
+    free_display_list(&page->frame);
+    free(page->highlight_rows);
+    free(page->highlight_links);
+    free(page->link_grid);
+    page->highlight_rows = NULL;
+    page->highlight_rows_capacity = 0;
+    page->highlight_row_size = 0;
+    page->highlight_links = NULL;
+    page->highlight_links_size = 0;
+    page->highlight_links_capacity = 0;
+    page->link_grid = NULL;
+    page->link_grid_capacity = 0;
+    page->old_link = NULL;
+    page->kept = false;
+}
+
+/**
+ * Heap memory of the page, the parser struct is always part of the history
+ */
+static size_t history_page_memory(const history_page* page)
+{
+    return html_parser_memory(&page->parser) - sizeof(html_parser)
+        + sizeof(display_run) * page->frame.capacity + page->frame.text_capacity
+        + sizeof(link_highlight_row) * page->highlight_rows_capacity
+        + sizeof(link_highlight) * page->highlight_links_capacity
+        + sizeof(int) * page->link_grid_capacity;
+}
+
+/**
+ * Free the pages until the history fits in HISTORY_MEMORY_BUDGET.
+ * Spare memory goes first, then the pages that were left longest ago.
+ */
+static void trim_history_pages(browser_history* history, const history_page* keep)
+{
+    for (;;) {
+        size_t memory = 0;
+        history_page* victim = NULL;
+        for (int i = 0; i < HISTORY_CAPACITY; i++) {
+            history_page* page = &history->pages[i];
+            size_t page_memory = history_page_memory(page);
+            memory += page_memory;
+            if (page == keep || page_memory == 0)
+                continue;
+            if (victim == NULL || (victim->kept && (!page->kept || page->last_used < victim->last_used)))
+                victim = page;
+        }
+
+        if (memory <= HISTORY_MEMORY_BUDGET || victim == NULL)
+            return;
+        free_history_page(victim);
+    }
+}
+
+/**
+ * Keep the shown page and its layout with its history entry before the
+ * parser is used for the next page. The parser gets the spare memory of
+ * the entry and keeps its link.
+ * Returns false if the page is not kept.
+ */
+static bool keep_history_page(drawer* drawer, html_parser* parser)
+{
+    if (drawer->page_index < 0)
+        return false;
+
+    history_page* page = &drawer->history.pages[drawer->page_index];
+    char link[HTML_LINK_SIZE + 1];
+    memcpy(link, parser->link, sizeof(link));
+    swap_history_page(drawer, parser, page);
+    memcpy(parser->link, link, sizeof(link));
+
+    page->kept = true;
+    memcpy(page->link, drawer->page_link, sizeof(page->link));
+    memcpy(page->parser.link, drawer->page_link, sizeof(page->parser.link));
+    // Link highlights point to the top and bottom navigation inside the parser.
+    // A page that was covered by a preview is laid out again
+    page->owner = drawer->preview_drawn ? NULL : parser;
+    page->lines = LINES;
+    page->cols = COLS;
+    page->last_used = ++drawer->history.clock;
+    drawer->page_index = -1;
+
+    // Spare layout is laid out again before it's shown
+    drawer->frame.size = 0;
+    drawer->frame.text_size = 0;
+    drawer->highlight_row_size = 0;
+    drawer->highlight_links_size = 0;
+    drawer->old_link = NULL;
+
+    trim_history_pages(&drawer->history, page);
+    return true;
+}
+
+/**
+ * Move the kept page of the history entry back to the parser
+ */
+static void take_history_page(drawer* drawer, html_parser* parser, int index)
+{
+    history_page* page = &drawer->history.pages[index];
+    swap_history_page(drawer, parser, page);
+    page->kept = false;
+    drawer->preview_drawn = false;
+    memcpy(drawer->page_link, parser->link, HTML_LINK_SIZE + 1);
+    drawer->page_index = index;
+}
+
+/**
+ * Show the kept page of the current history entry without loading it or
+ * laying it out again, only the difference to the screen is drawn.
+ * Returns false if the page is not kept.
+ */
+static bool show_history_page(drawer* drawer, html_parser* parser)
+{
+    int index = drawer->history.current;
+    history_page* page = &drawer->history.pages[index];
+    if (!page->kept || index == drawer->page_index)
+        return false;
+    // Entry may have been replaced with another link since
+    if (memcmp(page->link, drawer->history.entries[index], HTML_LINK_SIZE) != 0)
+        return false;
+
+    keep_history_page(drawer, parser);
+    take_history_page(drawer, parser, index);
+    drawer->error_drawn = false;
+    draw_page_info(drawer, parser);
+    if (page->owner == parser && page->lines == LINES && page->cols == COLS) {
+        drawer->init_highlight_rows = false;
+        render_frame(drawer);
+    } else {
+        draw_page(drawer, parser, true);
+    }
+
+    prefetch_neighbours(drawer);
+    return true;
 }
 
 // Go round and round
 static void next_col(drawer* drawer)
 {
+    if (drawer->highlight_row >= drawer->highlight_row_size)
+        return;
+
     link_highlight_row current = drawer->highlight_rows[drawer->highlight_row];
     drawer->highlight_col++;
     if (drawer->highlight_col >= current.size)
@@ -645,6 +1112,9 @@ static void next_col(drawer* drawer)
 
 static void prev_col(drawer* drawer)
 {
+    if (drawer->highlight_row >= drawer->highlight_row_size)
+        return;
+
     link_highlight_row current = drawer->highlight_rows[drawer->highlight_row];
     drawer->highlight_col--;
     if (drawer->highlight_col < 0)
@@ -654,6 +1124,9 @@ static void prev_col(drawer* drawer)
 // Go round and round
 static void next_row(drawer* drawer)
 {
+    if (drawer->highlight_row_size == 0)
+        return;
+
     drawer->highlight_row++;
     if (drawer->highlight_row >= drawer->highlight_row_size)
         drawer->highlight_row = 0;
@@ -667,6 +1140,9 @@ static void next_row(drawer* drawer)
 
 static void prev_row(drawer* drawer)
 {
+    if (drawer->highlight_row_size == 0)
+        return;
+
     drawer->highlight_row--;
     if (drawer->highlight_row < 0)
         drawer->highlight_row = drawer->highlight_row_size - 1;
@@ -678,15 +1154,198 @@ static void prev_row(drawer* drawer)
         drawer->highlight_col = next.size - 1;
 }
 
-static void load_link(drawer* drawer, html_parser* parser, bool add_history)
+static void draw_load_progress(drawer* drawer, const char* link, page_load_progress progress)
 {
-    draw_to_info_window(drawer, "Loading page...");
-    free_html_parser(parser);
-    init_html_parser(parser);
+    char info[128];
+    snprintf(info, sizeof(info), "Loading page %.3s... %zu kB, %.1f s. Press esc to cancel",
+        link, progress.received / 1024, progress.seconds);
+    draw_to_info_window(drawer, info);
+}
+
+/**
+ * Draw the title, top navigation and the middle of the loading page
+ * as soon as they are parsed. The whole page is drawn after the load.
+ */
+static void draw_load_preview(drawer* drawer)
+{
+    if (!page_worker_preview(&drawer->worker, &drawer->preview))
+        return;
+
+    html_section parsed = drawer->preview.parsed;
+    if (parsed < HTML_SECTION_TOP_NAVIGATION || parsed == HTML_SECTION_ALL)
+        return;
+
+    reset_frame(drawer);
+    // Highlight rows are initialized again when the whole page is drawn
+    drawer->init_highlight_rows = true;
+    clear_link_highlights(drawer);
+    drawer->preview_drawn = true;
+
+    draw_title(drawer, &drawer->preview);
+    draw_top_navigation(drawer, &drawer->preview);
+    if (parsed >= HTML_SECTION_MIDDLE)
+        draw_middle(drawer, &drawer->preview);
+    render_frame(drawer);
+}
+
+/**
+ * Draw the page in the parser again after the preview of a cancelled load
+ */
+static void draw_previous_page(drawer* drawer, html_parser* parser)
+{
+    if (!drawer->preview_drawn)
+        return;
+
+    if (parser->curl_load_error) {
+        // Load error pages have nothing to draw
+        reset_frame(drawer);
+        clear_link_highlights(drawer);
+        drawer->preview_drawn = false;
+        render_frame(drawer);
+    } else {
+        draw_page(drawer, parser, true);
+    }
+}
+
+/**
+ * Give the keys back to ncurses so the next getch calls return them
+ */
+static void push_back_keys(const int* keys, size_t count, MEVENT* mouse)
+{
+    // Pushed keys are returned first, so the last key is pushed first
+    for (size_t i = count; i-- > 0;) {
+        if (keys[i] == KEY_MOUSE)
+            ungetmouse(mouse);
+        else
+            ungetch(keys[i]);
+    }
+}
+
+/**
+ * Read the keys until the page worker has loaded the page.
+ * The previous page stays in the parser meanwhile, the loaded
+ * sections are drawn over it. Other keys than esc and q are
+ * handled after the load.
+ * Returns false if the load was cancelled with esc or q.
+ */
+static bool wait_for_page(drawer* drawer, html_parser* parser, const char* link)
+{
+    page_load_progress progress = page_worker_progress(&drawer->worker);
+    draw_load_progress(drawer, link, progress);
+    html_section drawn = HTML_SECTION_NONE;
+    int keys[LOAD_KEY_QUEUE_SIZE];
+    size_t key_count = 0;
+    // Only the latest click is kept
+    MEVENT mouse;
+    bool has_mouse = false;
+    while (progress.state != PAGE_WORKER_DONE) {
+        if (page_worker_wait(&drawer->worker, LOAD_PROGRESS_INTERVAL_MS) & PAGE_WORKER_INPUT) {
+            // Read every key ncurses has buffered, poll only sees the unread ones
+            nodelay(stdscr, TRUE);
+            int c;
+            while ((c = getch()) != ERR) {
+                if (c == 27 || c == 'q') { // esc or q
+                    nodelay(stdscr, FALSE);
+                    page_worker_cancel(&drawer->worker);
+                    draw_previous_page(drawer, parser);
+                    // Keys pressed before the cancel are dropped with the load,
+                    // but q still quits
+                    if (c == 'q')
+                        ungetch(c);
+                    return false;
+                } else if (c == KEY_RESIZE) {
+                    set_main_window_size(drawer);
+                    // Preview is drawn again below
+                    if (drawer->preview_drawn)
+                        drawn = HTML_SECTION_NONE;
+                    else if (!parser->curl_load_error)
+                        draw_page(drawer, parser, true);
+                } else if (c == KEY_MOUSE) {
+                    if (getmouse(&mouse) != OK)
+                        continue;
+                    if (!has_mouse && key_count < LOAD_KEY_QUEUE_SIZE)
+                        keys[key_count++] = c;
+                    has_mouse = true;
+                } else if (key_count < LOAD_KEY_QUEUE_SIZE) {
+                    keys[key_count++] = c;
+                }
+            }
+            nodelay(stdscr, FALSE);
+        }
+
+        progress = page_worker_progress(&drawer->worker);
+        // The preview is only drawn again when more of the page is parsed
+        if (progress.parsed != drawn) {
+            draw_load_preview(drawer);
+            drawn = progress.parsed;
+        }
+        draw_load_progress(drawer, link, progress);
+    }
+
+    push_back_keys(keys, key_count, &mouse);
+    return true;
+}
+
+/**
+ * Load the page from the network, ignoring the cached and prefetched pages.
+ * Returns false if the load was cancelled and the previous page is kept.
+ */
+static bool reload_link(drawer* drawer, html_parser* parser, bool add_history)
+{
+    char link[HTML_LINK_SIZE + 1];
+    memcpy(link, parser->link, HTML_LINK_SIZE + 1);
+    if (page_worker_start(&drawer->worker, link, parser->sections)) {
+        // Parser keeps the previous page until the new one is loaded
+        memcpy(parser->link, drawer->page_link, HTML_LINK_SIZE + 1);
+        if (!wait_for_page(drawer, parser, link)) {
+            if (parser->curl_load_error)
+                draw_to_info_window(drawer, LOAD_ERROR_INFO);
+            else
+                draw_page_info(drawer, parser);
+            return false;
+        }
+        keep_history_page(drawer, parser);
+        page_worker_take(&drawer->worker, parser);
+    } else {
+        draw_to_info_window(drawer, "Loading page...");
+        keep_history_page(drawer, parser);
+        // Highlights point to the parser that is about to be reset
+        clear_link_highlights(drawer);
+        // The loader resets the parser and reuses its memory
+        loader_load_page(drawer->loader, parser);
+    }
 
-    load_page(parser);
-    parse_html(parser);
+    page_cache_put(&drawer->cache, parser);
     redraw_parser(drawer, parser, true, add_history);
+    return true;
+}
+
+/**
+ * Returns false if the page wasn't loaded because the load was cancelled.
+ */
+bool load_link(drawer* drawer, html_parser* parser, bool add_history)
+{
+    // The shown page is kept before the parser is replaced, and
+    // given back if the page has to be loaded from the network
+    int index = drawer->page_index;
+    char link[HTML_LINK_SIZE + 1];
+    memcpy(link, parser->link, sizeof(link));
+    bool kept = keep_history_page(drawer, parser);
+
+    if (page_cache_get(&drawer->cache, parser)) {
+        redraw_parser(drawer, parser, true, add_history);
+        return true;
+    } else if (prefetch_take(&drawer->prefetch, parser)) {
+        page_cache_put(&drawer->cache, parser);
+        redraw_parser(drawer, parser, true, add_history);
+        return true;
+    }
+
+    if (kept) {
+        take_history_page(drawer, parser, index);
+        memcpy(parser->link, link, sizeof(link));
+    }
+    return reload_link(drawer, parser, add_history);
 }
 
 static void load_highlight_link(drawer* drawer, html_parser* parser)
@@ -695,8 +1354,11 @@ static void load_highlight_link(drawer* drawer, html_parser* parser)
     if (drawer->highlight_col == -1 || drawer->highlight_row == -1)
         return;
 
-    link_highlight link = drawer->highlight_rows[drawer->highlight_row].links[drawer->highlight_col];
-    link_from_short_link(parser, html_link_link(link.link));
+    link_highlight* link = highlight_link(drawer, drawer->highlight_row, drawer->highlight_col);
+    if (link == NULL)
+        return;
+
+    link_from_short_link(parser, (char*)html_link_link(*link->link));
     load_link(drawer, parser, true);
 }
 
@@ -705,16 +1367,16 @@ static void load_nav_link(drawer* drawer, html_parser* parser, nav_type type)
     char* link = NULL;
     switch (type) {
     case NEXT_PAGE:
-        link = nav_links.next_page;
+        link = drawer->nav_links.next_page;
         break;
     case PREV_PAGE:
-        link = nav_links.prev_page;
+        link = drawer->nav_links.prev_page;
         break;
     case NEXT_SUB_PAGE:
-        link = nav_links.next_sub_page;
+        link = drawer->nav_links.next_sub_page;
         break;
     case PREV_SUB_PAGE:
-        link = nav_links.prev_sub_page;
+        link = drawer->nav_links.prev_sub_page;
         break;
     default:
         break;
@@ -743,7 +1405,8 @@ static void print_navigation_line(drawer* drawer, const char* line)
 static void draw_navigation_screen(drawer* drawer, html_parser* parser)
 {
     // First clear the window
-    wclear(drawer->window);
+    werase(drawer->window);
+    drawer->shown_invalid = true;
     draw_to_info_window(drawer, "Press q to return");
 
     drawer->current_x = middle_startx();
@@ -764,7 +1427,7 @@ static void draw_navigation_screen(drawer* drawer, html_parser* parser)
     print_navigation_line(drawer, "| o       | Previous page          |");
     print_navigation_line(drawer, "| p       | Next page              |");
     print_navigation_line(drawer, "| i       | Show navigation help   |");
-    print_navigation_line(drawer, "| esc     | Cancel search mode     |");
+    print_navigation_line(drawer, "| esc     | Cancel search or load  |");
     print_navigation_line(drawer, "| q       | Quit program           |");
 
     // Refresh to show the new text
@@ -879,13 +1542,13 @@ void main_draw_loop(drawer* drawer, html_parser* parser)
         } else if (c == 's') {
             search_mode(drawer, parser);
         } else if (c == 'r') {
-            load_link(drawer, parser, false);
+            reload_link(drawer, parser, false);
         } else if (c == KEY_MOUSE) {
             MEVENT event;
             if (getmouse(&event) == OK && event.bstate & BUTTON1_CLICKED) {
-                char link_buf[HTML_LINK_SIZE + 1];
-                if (find_link_highlight(drawer, event.x, event.y, link_buf)) {
-                    link_from_short_link(parser, link_buf);
+                link_highlight* link = find_link_highlight(drawer, event.x, event.y);
+                if (link != NULL) {
+                    link_from_short_link(parser, (char*)html_link_link(*link->link));
                     load_link(drawer, parser, true);
                 }
             }
@@ -895,28 +1558,22 @@ void main_draw_loop(drawer* drawer, html_parser* parser)
 
 void draw_parser(drawer* drawer, html_parser* parser)
 {
+    memcpy(drawer->page_link, parser->link, HTML_LINK_SIZE + 1);
     if (parser->curl_load_error) {
         curl_load_error(drawer, parser);
     } else {
-        drawer->init_highlight_rows = true;
-        memset(drawer->highlight_rows, 0, sizeof(link_highlight_row) * 32);
-
-        draw_to_info_window(drawer, "Press q to exit, s to search");
-        draw_title(drawer, parser);
-        draw_top_navigation(drawer, parser);
-        draw_middle(drawer, parser);
-        draw_sub_pages(drawer, parser);
-        draw_bottom_navigation(drawer, parser);
-        wrefresh(drawer->window);
-
-        add_history_link(parser->link);
+        draw_page(drawer, parser, true);
+        add_history_link(&drawer->history, parser->link);
+        drawer->page_index = drawer->history.current;
+        page_cache_put(&drawer->cache, parser);
+        prefetch_neighbours(drawer);
     }
 
     main_draw_loop(drawer, parser);
     endwin();
 }
 
-void init_drawer(drawer* drawer)
+void init_drawer(drawer* drawer, const config* conf, page_loader* loader)
 {
 #ifndef DISABLE_UTF_8
     // Make sure that locale is set so ncurses can show UTF-8 properly
@@ -947,6 +1604,30 @@ void init_drawer(drawer* drawer)
 
     drawer->window = NULL;
     drawer->info_window = NULL;
+    drawer->config = conf;
+    drawer->loader = loader;
+    drawer->highlight_row = -1;
+    drawer->highlight_col = -1;
+    drawer->highlight_row_size = 0;
+    drawer->highlight_rows = NULL;
+    drawer->highlight_rows_capacity = 0;
+    drawer->highlight_links = NULL;
+    drawer->highlight_links_size = 0;
+    drawer->highlight_links_capacity = 0;
+    drawer->link_grid = NULL;
+    drawer->link_grid_capacity = 0;
+    memset(&drawer->frame, 0, sizeof(display_list));
+    memset(&drawer->shown, 0, sizeof(display_list));
+    drawer->old_link = NULL;
+    init_browser_history(&drawer->history);
+    memset(&drawer->nav_links, 0, sizeof(navigation));
+    memset(drawer->page_link, 0, sizeof(drawer->page_link));
+    drawer->page_index = -1;
+    init_page_worker(&drawer->worker, loader);
+    init_html_parser(&drawer->preview);
+    drawer->preview_drawn = false;
+    init_prefetcher(&drawer->prefetch, loader);
+    init_page_cache(&drawer->cache, drawer->config->cache_size, drawer->config->cache_ttl);
     set_main_window_size(drawer);
 }
 
@@ -954,4 +1635,28 @@ void free_drawer(drawer* drawer)
 {
     delwin(drawer->window);
     delwin(drawer->info_window);
+    free_page_worker(&drawer->worker);
+    free_html_parser(&drawer->preview);
+    free_prefetcher(&drawer->prefetch);
+    free_page_cache(&drawer->cache);
+    free(drawer->highlight_rows);
+    free(drawer->highlight_links);
+    free(drawer->link_grid);
+    free_display_list(&drawer->frame);
+    free_display_list(&drawer->shown);
+    free_browser_history(&drawer->history);
+}
+
+void init_browser_history(browser_history* history)
+{
+    memset(history, 0, sizeof(browser_history));
+    history->current = -1;
+    for (int i = 0; i < HISTORY_CAPACITY; i++)
+        init_html_parser(&history->pages[i].parser);
+}
+
+void free_browser_history(browser_history* history)
+{
+    for (int i = 0; i < HISTORY_CAPACITY; i++)
+        free_history_page(&history->pages[i]);
 }
@@ -4,18 +4,122 @@
 #include <ncurses.h>
 #include <stdbool.h>
 
+#include "config.h"
+#include "page_cache.h"
+#include "page_worker.h"
+#include "prefetch.h"
+
 typedef struct {
-    html_link link;
+    // Link of the drawn parser, valid until the next page is drawn
+    const html_link* link;
     int start_x;
     int start_y;
+    // Displayed width of the link text
+    int width;
+    // Index of the link's run in drawer.frame
+    int run;
 } link_highlight;
 
+typedef enum {
+    DISPLAY_TEXT,
+    DISPLAY_LINK,
+    DISPLAY_HIGHLIGHT,
+} display_style;
+
+// Text drawn to a position of the main window
 typedef struct {
-    link_highlight links[16];
+    int x;
+    int y;
+    int width;
+    display_style style;
+    // Offset of the NUL terminated text in display_list.text
+    size_t text;
+    size_t size;
+} display_run;
+
+/**
+ * Everything drawn to the main window, added row by row from the top.
+ * The texts are copied so the list stays valid when the parser is reset.
+ */
+typedef struct {
+    display_run* runs;
+    int size;
+    int capacity;
+    char* text;
+    size_t text_size;
+    size_t text_capacity;
+    // Some run continues past the right edge and wraps to the next row
+    bool overflow;
+} display_list;
+
+typedef struct {
+    // Index of the row's first link in drawer.highlight_links
+    int first;
     int size;
 } link_highlight_row;
 
+// Links of the top navigation, used by the navigation hotkeys
+typedef struct {
+    char prev_page[HTML_LINK_SIZE];
+    char next_page[HTML_LINK_SIZE];
+    char prev_sub_page[HTML_LINK_SIZE];
+    char next_sub_page[HTML_LINK_SIZE];
+} navigation;
+
+#define HISTORY_CAPACITY 16
+// Heap memory the pages kept with the history may take
+#define HISTORY_MEMORY_BUDGET (2 * 1024 * 1024)
+
+/**
+ * Page that was left and its layout, kept with the history entry so
+ * going back and forward doesn't load or lay out the page again.
+ * The fields are swapped with the drawer's, so a page that is not kept
+ * holds spare memory for the next page instead.
+ */
 typedef struct {
+    bool kept;
+    char link[HTML_LINK_SIZE + 1];
+    html_parser parser;
+    // Parser the link highlights pointed to, they're only valid in it
+    const html_parser* owner;
+    // Screen size the page was laid out for
+    int lines;
+    int cols;
+    display_list frame;
+    link_highlight_row* highlight_rows;
+    int highlight_rows_capacity;
+    int highlight_row_size;
+    link_highlight* highlight_links;
+    int highlight_links_size;
+    int highlight_links_capacity;
+    int* link_grid;
+    int link_grid_capacity;
+    int highlight_row;
+    int highlight_col;
+    link_highlight* old_link;
+    navigation nav_links;
+    // Value of history.clock when the page was left
+    unsigned long last_used;
+} history_page;
+
+typedef struct {
+    // Storage for browser links
+    char entries[HISTORY_CAPACITY][HTML_LINK_SIZE];
+    int count; // Amount of items in the buffer
+    int start; // Start of the valid data
+    int current; // Index of the value we are currently using
+    // Pages of the entries, valid while the link of the entry is the same
+    history_page pages[HISTORY_CAPACITY];
+    // Incremented every time a page is kept
+    unsigned long clock;
+} browser_history;
+
+/**
+ * All the state of a single drawer. Nothing is shared between drawers
+ * except the config and the loader given to init_drawer.
+ */
+typedef struct {
+    const config* config;
     WINDOW* info_window;
     WINDOW* window;
     int window_start_x;
@@ -35,15 +139,60 @@ typedef struct {
     int highlight_row;
     int highlight_col;
     bool init_highlight_rows;
-    link_highlight_row highlight_rows[32];
+    // Both grow to fit the links of the page
+    link_highlight_row* highlight_rows;
+    int highlight_rows_capacity;
+    link_highlight* highlight_links;
+    int highlight_links_size;
+    int highlight_links_capacity;
     int highlight_row_size;
+    // Index + 1 of the link drawn in each cell of the window, 0 for no link.
+    // Mouse clicks are mapped to the links with this.
+    int* link_grid;
+    int link_grid_capacity;
     bool error_drawn; // Was the last page drawn a load error page
+    // Link that was highlighted before the current one
+    link_highlight* old_link;
+    browser_history history;
+    navigation nav_links;
+
+    // Layout of the current page
+    display_list frame;
+    // What the main window shows, only the difference to it is drawn
+    display_list shown;
+    // The main window was changed without the display lists
+    bool shown_invalid;
 
+    // Loader shared by every page load so the connection stays open
+    page_loader* loader;
+    // Loads the opened pages while the keys are still read
+    page_worker worker;
+    // Sections of the loading page that are drawn before it's loaded
+    html_parser preview;
+    // The frame shows the preview instead of the page in the parser
+    bool preview_drawn;
+    // Link of the page in the parser, callers change parser->link
+    // before the load so a cancelled load restores it from here
+    char page_link[HTML_LINK_SIZE + 1];
+    // History entry of the page in the parser, -1 for load error pages
+    int page_index;
+    // Loads the neighbouring pages in the background
+    prefetcher prefetch;
+    // Already loaded pages for history navigation and revisits
+    page_cache cache;
 } drawer;
 
-void init_drawer(drawer* drawer);
+void init_drawer(drawer* drawer, const config* conf, page_loader* loader);
 void free_drawer(drawer* drawer);
+void init_browser_history(browser_history* history);
+void free_browser_history(browser_history* history);
 
 void draw_parser(drawer* drawer, html_parser* parser);
+// Draw and navigate without reading the keys, the benchmarks use these too
+void draw_page(drawer* drawer, html_parser* parser, bool init);
+void draw_highlight(drawer* drawer, int row, int col);
+bool load_link(drawer* drawer, html_parser* parser, bool add_history);
+void load_prev_link(drawer* drawer, html_parser* parser);
+void load_next_link(drawer* drawer, html_parser* parser);
 
 #endif
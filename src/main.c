@@ -30,6 +30,9 @@ static void print_usage(char* name)
     printf("\t--default-colors\tDisable all custom coloring. Including custom link colors\n");
     printf("\t\t\t\tUse colors based on the console theme instead\n");
     printf("\t--show-time <format>\tShow time. Optional strftime format as argument.\n");
+    printf("\t--cache-size <pages>\tHow many pages are kept in memory. 0 disables the cache (32)\n");
+    printf("\t--cache-ttl <seconds>\tHow long pages are kept in memory. 0 keeps them forever (300)\n");
+    printf("\t--no-disk-cache\t\tDon't store pages to ~/.cache/tekstitv\n");
     exit(0);
 }
 
@@ -49,6 +52,11 @@ static void print_config_options(void)
     printf("\tlink-color=<hex>\t\tLink highlight color hex value (ffffff)\n");
     printf("\tshow-time=false|true|format\tShow time. True is default format,\n");
     printf("\t\t\t\t\tformat arg is custom strftime format\n");
+    printf("\tcache-size=<pages>\t\tHow many pages are kept in memory (32)\n");
+    printf("\t\t\t\t\t0 disables the cache\n");
+    printf("\tcache-ttl=<seconds>\t\tHow long pages are kept in memory (300)\n");
+    printf("\t\t\t\t\t0 keeps them forever\n");
+    printf("\tno-disk-cache=true|false\tDon't store pages to ~/.cache/tekstitv\n");
     exit(0);
 }
 
@@ -77,8 +85,10 @@ static void print_verbose_navigation_instructions(void)
     printf("| o       | Previous page          | -                                                   |\n");
     printf("| p       | Next page              | -                                                   |\n");
     printf("| i       | Show navigation help   | -                                                   |\n");
-    printf("| esc     | Cancel search mode     | Works only in search mode                           |\n");
-    printf("| q       | Quit program           | Works only if not in search mode                    |\n");
+    printf("| esc     | Cancel search or load  | Keeps the previous page when a load is cancelled    |\n");
+    printf("| q       | Quit program           | Not in search mode, cancels the running load first  |\n");
+    printf("\n");
+    printf("Other keys pressed while a page is loading are handled once it has loaded.\n");
     printf("\n");
     exit(0);
 }
@@ -102,12 +112,34 @@ static void print_navigation_instructions(void)
     printf("| o       | Previous page          |\n");
     printf("| p       | Next page              |\n");
     printf("| i       | Show navigation help   |\n");
-    printf("| esc     | Cancel search mode     |\n");
+    printf("| esc     | Cancel search or load  |\n");
     printf("| q       | Quit program           |\n");
     printf("\n");
     exit(0);
 }
 
+/**
+ * Only parse the sections of the page that are shown
+ */
+static unsigned shown_sections(const config* conf)
+{
+    unsigned sections = HTML_PARSE_ALL;
+    // Text only mode prints the title and the middle
+    if (conf->text_only)
+        sections = HTML_PARSE_TITLE | HTML_PARSE_MIDDLE;
+    if (conf->no_title)
+        sections &= ~HTML_PARSE_TITLE;
+    if (conf->no_middle)
+        sections &= ~HTML_PARSE_MIDDLE;
+    if (conf->no_sub_page)
+        sections &= ~HTML_PARSE_SUB_PAGES;
+    // Top navigation is always needed for the navigation hotkeys
+    if (conf->no_nav || conf->no_bottom_nav)
+        sections &= ~HTML_PARSE_BOTTOM_NAVIGATION;
+
+    return sections;
+}
+
 int main(int argc, char** argv)
 {
 
@@ -141,22 +173,35 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    if (!init_tekstitv()) {
+        fprintf(stderr, "Couldn't initialize libcurl\n");
+        return 1;
+    }
+
+    page_loader loader;
+    init_page_loader(&loader);
+    // Unchanged pages are not downloaded again and cached pages are shown when offline
+    if (!global_config.no_disk_cache)
+        loader_use_disk_cache(&loader, NULL);
+
     html_parser parser;
     init_html_parser(&parser);
+    parser.sections = shown_sections(&global_config);
     link_from_ints(&parser, global_config.page, global_config.subpage);
-    load_page(&parser);
-    parse_html(&parser);
+    loader_load_page(&loader, &parser);
 
     if (global_config.text_only) {
-        print_parser(&parser);
+        print_parser(&global_config, &parser);
     } else {
         drawer drawer;
-        init_drawer(&drawer);
+        init_drawer(&drawer, &global_config, &loader);
         draw_parser(&drawer, &parser);
         free_drawer(&drawer);
     }
 
     free_config(&global_config);
     free_html_parser(&parser);
+    free_page_loader(&loader);
+    free_tekstitv();
     return 0;
 }
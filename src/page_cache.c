@@ -0,0 +1,110 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "page_cache.h"
+
+static bool is_expired(page_cache* cache, page_cache_entry* entry)
+{
+    return cache->ttl > 0 && time(NULL) - entry->loaded_at > cache->ttl;
+}
+
+static void remove_entry(page_cache* cache, page_cache_entry* entry)
+{
+    free_html_parser(&entry->parser);
+    // Order of the entries doesn't matter so just fill the hole with the last one
+    *entry = cache->entries[--cache->size];
+}
+
+/**
+ * Find the entry for the link. Expired entries are removed.
+ */
+static page_cache_entry* find_entry(page_cache* cache, const char* link)
+{
+    for (size_t i = 0; i < cache->size; i++) {
+        page_cache_entry* entry = &cache->entries[i];
+        if (memcmp(entry->link, link, HTML_LINK_SIZE) != 0)
+            continue;
+
+        if (is_expired(cache, entry)) {
+            remove_entry(cache, entry);
+            return NULL;
+        }
+
+        return entry;
+    }
+
+    return NULL;
+}
+
+void init_page_cache(page_cache* cache, size_t capacity, time_t ttl)
+{
+    cache->size = 0;
+    cache->capacity = capacity;
+    cache->ttl = ttl;
+    cache->clock = 0;
+    cache->entries = capacity > 0 ? malloc(capacity * sizeof(page_cache_entry)) : NULL;
+}
+
+void free_page_cache(page_cache* cache)
+{
+    for (size_t i = 0; i < cache->size; i++)
+        free_html_parser(&cache->entries[i].parser);
+
+    free(cache->entries);
+    cache->entries = NULL;
+    cache->size = 0;
+}
+
+bool page_cache_contains(page_cache* cache, const char* link)
+{
+    return find_entry(cache, link) != NULL;
+}
+
+/**
+ * Copy the cached page for parser->link to the parser.
+ * Returns false if the page is not cached or there was not enough memory
+ * to copy it, the parser has to be loaded again then.
+ */
+bool page_cache_get(page_cache* cache, html_parser* parser)
+{
+    page_cache_entry* entry = find_entry(cache, parser->link);
+    if (entry == NULL)
+        return false;
+
+    entry->last_used = ++cache->clock;
+    // The parser's memory is reused for the copy
+    unsigned sections = parser->sections;
+    bool copied = copy_html_parser(parser, &entry->parser);
+    parser->sections = sections;
+    return copied;
+}
+
+/**
+ * Store a copy of the loaded page. Least recently used page
+ * is dropped if the cache is full.
+ */
+void page_cache_put(page_cache* cache, html_parser* parser)
+{
+    if (cache->capacity == 0 || parser->curl_load_error)
+        return;
+
+    // The old page's memory is reused when the entry is replaced
+    page_cache_entry* entry = find_entry(cache, parser->link);
+    if (entry == NULL && cache->size < cache->capacity) {
+        entry = &cache->entries[cache->size++];
+        init_html_parser(&entry->parser);
+    } else if (entry == NULL) {
+        entry = &cache->entries[0];
+        for (size_t i = 1; i < cache->size; i++) {
+            if (cache->entries[i].last_used < entry->last_used)
+                entry = &cache->entries[i];
+        }
+    }
+
+    memcpy(entry->link, parser->link, HTML_LINK_SIZE + 1);
+    entry->loaded_at = time(NULL);
+    entry->last_used = ++cache->clock;
+    // Partially copied pages are not cached
+    if (!copy_html_parser(&entry->parser, parser))
+        remove_entry(cache, entry);
+}
@@ -0,0 +1,35 @@
+#ifndef _PAGE_CACHE_H_
+#define _PAGE_CACHE_H_
+
+#include <stdbool.h>
+#include <tekstitv.h>
+#include <time.h>
+
+typedef struct {
+    char link[HTML_LINK_SIZE + 1];
+    time_t loaded_at;
+    // Value of the cache clock when the page was last used
+    unsigned long last_used;
+    html_parser parser;
+} page_cache_entry;
+
+/**
+ * Least recently used cache of parsed pages keyed by the short link
+ */
+typedef struct {
+    page_cache_entry* entries;
+    size_t size;
+    size_t capacity;
+    // Seconds until a page is loaded again, 0 keeps pages forever
+    time_t ttl;
+    // Incremented every time the cache is used
+    unsigned long clock;
+} page_cache;
+
+void init_page_cache(page_cache* cache, size_t capacity, time_t ttl);
+void free_page_cache(page_cache* cache);
+bool page_cache_contains(page_cache* cache, const char* link);
+bool page_cache_get(page_cache* cache, html_parser* parser);
+void page_cache_put(page_cache* cache, html_parser* parser);
+
+#endif
@@ -0,0 +1,246 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "page_worker.h"
+
+static void notify_ui(page_worker* worker)
+{
+    // The pipe is non-blocking, a full pipe already wakes up the ui
+    ssize_t written = write(worker->notify[1], "", 1);
+    (void)written;
+}
+
+/**
+ * Progress callback of the loader, runs in the worker thread
+ */
+static void report_progress(html_parser* parser, void* data)
+{
+    page_worker* worker = data;
+    pthread_mutex_lock(&worker->lock);
+    // The loader keeps using the parser without the lock,
+    // so the ui thread gets a copy of the new sections
+    if (parser->parsed != worker->progress.parsed && copy_html_parser(&worker->preview, parser))
+        worker->progress.parsed = parser->parsed;
+    worker->progress.received = parser->_curl_buffer.size;
+    pthread_mutex_unlock(&worker->lock);
+    notify_ui(worker);
+}
+
+static void* page_worker_thread(void* data)
+{
+    page_worker* worker = data;
+
+    pthread_mutex_lock(&worker->lock);
+    while (!worker->quit) {
+        if (!worker->pending) {
+            pthread_cond_wait(&worker->work, &worker->lock);
+            continue;
+        }
+
+        // The ui thread doesn't touch the parser or the loader while
+        // the page is loading, so they are used without the lock
+        worker->pending = false;
+        pthread_mutex_unlock(&worker->lock);
+
+        loader_load_page(worker->loader, &worker->parser);
+
+        pthread_mutex_lock(&worker->lock);
+        worker->progress.parsed = worker->parser.parsed;
+        worker->progress.received = worker->parser._curl_buffer.size;
+        worker->progress.state = PAGE_WORKER_DONE;
+        pthread_cond_broadcast(&worker->done);
+        notify_ui(worker);
+    }
+    pthread_mutex_unlock(&worker->lock);
+
+    return NULL;
+}
+
+static bool open_notify_pipe(page_worker* worker)
+{
+    if (pipe(worker->notify) != 0)
+        return false;
+
+    for (size_t i = 0; i < 2; i++) {
+        int flags = fcntl(worker->notify[i], F_GETFL);
+        fcntl(worker->notify[i], F_SETFL, flags | O_NONBLOCK);
+    }
+
+    return true;
+}
+
+/**
+ * Loads of the loader are reported to the worker from now on
+ */
+void init_page_worker(page_worker* worker, page_loader* loader)
+{
+    worker->quit = false;
+    worker->pending = false;
+    worker->loader = loader;
+    memset(&worker->progress, 0, sizeof(page_load_progress));
+    worker->progress.state = PAGE_WORKER_IDLE;
+    init_html_parser(&worker->parser);
+    init_html_parser(&worker->preview);
+    loader->on_progress = report_progress;
+    loader->progress_data = worker;
+    pthread_mutex_init(&worker->lock, NULL);
+    pthread_cond_init(&worker->work, NULL);
+    pthread_cond_init(&worker->done, NULL);
+
+    worker->running = false;
+    if (!open_notify_pipe(worker)) {
+        worker->notify[0] = -1;
+        worker->notify[1] = -1;
+        return;
+    }
+
+    // Without the worker thread the pages are loaded on the ui thread
+    worker->running = pthread_create(&worker->thread, NULL, page_worker_thread, worker) == 0;
+}
+
+void free_page_worker(page_worker* worker)
+{
+    pthread_mutex_lock(&worker->lock);
+    worker->quit = true;
+    // Abort the running load so quitting doesn't wait for the network
+    loader_set_cancel(worker->loader, true);
+    pthread_cond_signal(&worker->work);
+    pthread_mutex_unlock(&worker->lock);
+
+    if (worker->running)
+        pthread_join(worker->thread, NULL);
+
+    loader_set_cancel(worker->loader, false);
+    worker->loader->on_progress = NULL;
+    worker->loader->progress_data = NULL;
+    if (worker->notify[0] != -1) {
+        close(worker->notify[0]);
+        close(worker->notify[1]);
+    }
+
+    pthread_cond_destroy(&worker->done);
+    pthread_cond_destroy(&worker->work);
+    pthread_mutex_destroy(&worker->lock);
+    free_html_parser(&worker->parser);
+    free_html_parser(&worker->preview);
+}
+
+/**
+ * Start loading the link in the background. Waits for a cancelled load
+ * to finish first since the loader is busy until then.
+ * Returns false if there is no worker thread.
+ */
+bool page_worker_start(page_worker* worker, const char* link, unsigned sections)
+{
+    if (!worker->running)
+        return false;
+
+    pthread_mutex_lock(&worker->lock);
+    while (worker->progress.state == PAGE_WORKER_LOADING)
+        pthread_cond_wait(&worker->done, &worker->lock);
+
+    link_from_short_link(&worker->parser, (char*)link);
+    worker->parser.sections = sections;
+    loader_set_cancel(worker->loader, false);
+    memset(&worker->progress, 0, sizeof(page_load_progress));
+    worker->progress.state = PAGE_WORKER_LOADING;
+    worker->pending = true;
+    clock_gettime(CLOCK_MONOTONIC, &worker->started);
+    pthread_cond_signal(&worker->work);
+    pthread_mutex_unlock(&worker->lock);
+
+    return true;
+}
+
+/**
+ * Wait until there is terminal input or the load has progressed,
+ * at most timeout_ms milliseconds.
+ * Returns the PAGE_WORKER_INPUT and PAGE_WORKER_PROGRESS events that happened.
+ */
+int page_worker_wait(page_worker* worker, int timeout_ms)
+{
+    struct pollfd fds[2];
+    fds[0].fd = STDIN_FILENO;
+    fds[0].events = POLLIN;
+    fds[1].fd = worker->notify[0];
+    fds[1].events = POLLIN;
+
+    if (poll(fds, 2, timeout_ms) < 0) {
+        // Signals like SIGWINCH interrupt the poll, ncurses turns them into keys
+        return errno == EINTR ? PAGE_WORKER_INPUT : 0;
+    }
+
+    int events = 0;
+    if (fds[0].revents != 0)
+        events |= PAGE_WORKER_INPUT;
+    if (fds[1].revents & POLLIN) {
+        char drain[64];
+        while (read(worker->notify[0], drain, sizeof(drain)) > 0)
+            ;
+        events |= PAGE_WORKER_PROGRESS;
+    }
+
+    return events;
+}
+
+page_load_progress page_worker_progress(page_worker* worker)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    pthread_mutex_lock(&worker->lock);
+    page_load_progress progress = worker->progress;
+    progress.seconds = (now.tv_sec - worker->started.tv_sec) + (now.tv_nsec - worker->started.tv_nsec) / 1e9;
+    pthread_mutex_unlock(&worker->lock);
+
+    return progress;
+}
+
+/**
+ * Abort the running load. The result is never taken, the next
+ * page_worker_start waits until the worker is done with it.
+ */
+void page_worker_cancel(page_worker* worker)
+{
+    pthread_mutex_lock(&worker->lock);
+    if (worker->progress.state == PAGE_WORKER_LOADING)
+        loader_set_cancel(worker->loader, true);
+    pthread_mutex_unlock(&worker->lock);
+}
+
+/**
+ * Copy the sections of the loading page that are parsed so far,
+ * progress.parsed tells which they are.
+ * Returns false if the copy is incomplete.
+ */
+bool page_worker_preview(page_worker* worker, html_parser* target)
+{
+    pthread_mutex_lock(&worker->lock);
+    bool copied = copy_html_parser(target, &worker->preview);
+    pthread_mutex_unlock(&worker->lock);
+    return copied;
+}
+
+/**
+ * Move the finished page to the parser
+ */
+void page_worker_take(page_worker* worker, html_parser* parser)
+{
+    pthread_mutex_lock(&worker->lock);
+    while (worker->progress.state == PAGE_WORKER_LOADING)
+        pthread_cond_wait(&worker->done, &worker->lock);
+
+    // Swap the parsers so the worker gets the old page's memory to reuse
+    html_parser old = *parser;
+    *parser = worker->parser;
+    worker->parser = old;
+    // Both keep parsing the same sections as before
+    worker->parser.sections = parser->sections;
+    parser->sections = old.sections;
+    worker->progress.state = PAGE_WORKER_IDLE;
+    pthread_mutex_unlock(&worker->lock);
+}
@@ -0,0 +1,68 @@
+#ifndef _PAGE_WORKER_H_
+#define _PAGE_WORKER_H_
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <tekstitv.h>
+#include <time.h>
+
+typedef enum {
+    PAGE_WORKER_IDLE,
+    PAGE_WORKER_LOADING,
+    PAGE_WORKER_DONE,
+} page_worker_state;
+
+// What the ui thread knows about the running load
+typedef struct {
+    page_worker_state state;
+    // Last section that is fully parsed and can be previewed
+    html_section parsed;
+    // Bytes of the page received so far
+    size_t received;
+    // Seconds since the load started
+    double seconds;
+} page_load_progress;
+
+// Events page_worker_wait returns
+#define PAGE_WORKER_INPUT (1 << 0)
+#define PAGE_WORKER_PROGRESS (1 << 1)
+
+/**
+ * Worker thread that loads the pages the user opens, so the ui thread
+ * keeps reading the keys and can cancel a slow load.
+ * Progress and the finished load are signaled through a pipe that is
+ * polled together with the terminal input.
+ */
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    // Signaled when a load is started or the worker should quit
+    pthread_cond_t work;
+    // Signaled when a load finishes
+    pthread_cond_t done;
+    bool quit;
+    bool running;
+    // Started load the worker hasn't picked up yet
+    bool pending;
+    // Read and write ends of the notification pipe
+    int notify[2];
+    // Loader shared with the ui thread, only the worker uses it while loading
+    page_loader* loader;
+    page_load_progress progress;
+    struct timespec started;
+    // Page is loaded here so the ui thread keeps the previous page
+    html_parser parser;
+    // Copy of the sections parsed so far, guarded by the lock
+    html_parser preview;
+} page_worker;
+
+void init_page_worker(page_worker* worker, page_loader* loader);
+void free_page_worker(page_worker* worker);
+bool page_worker_start(page_worker* worker, const char* link, unsigned sections);
+int page_worker_wait(page_worker* worker, int timeout_ms);
+page_load_progress page_worker_progress(page_worker* worker);
+void page_worker_cancel(page_worker* worker);
+bool page_worker_preview(page_worker* worker, html_parser* target);
+void page_worker_take(page_worker* worker, html_parser* parser);
+
+#endif
@@ -0,0 +1,204 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "prefetch.h"
+
+static bool slot_has_link(prefetch_slot* slot, const char* link)
+{
+    return slot->state != PREFETCH_EMPTY && slot->state != PREFETCH_CANCELLED && memcmp(slot->link, link, HTML_LINK_SIZE) == 0;
+}
+
+static prefetch_slot* find_slot(prefetcher* prefetch, const char* link)
+{
+    for (size_t i = 0; i < PREFETCH_SLOTS; i++) {
+        if (slot_has_link(&prefetch->slots[i], link))
+            return &prefetch->slots[i];
+    }
+
+    return NULL;
+}
+
+static bool is_wanted(prefetch_slot* slot, char** links, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (slot_has_link(slot, links[i]))
+            return true;
+    }
+
+    return false;
+}
+
+static bool is_stale(prefetch_slot* slot)
+{
+    return slot->state == PREFETCH_READY && time(NULL) - slot->loaded_at > PREFETCH_MAX_AGE;
+}
+
+static void* prefetch_worker(void* data)
+{
+    prefetcher* prefetch = (prefetcher*)data;
+
+    pthread_mutex_lock(&prefetch->lock);
+    while (!prefetch->quit) {
+        prefetch_slot* slot = NULL;
+        for (size_t i = 0; i < PREFETCH_SLOTS; i++) {
+            if (prefetch->slots[i].state == PREFETCH_QUEUED) {
+                slot = &prefetch->slots[i];
+                break;
+            }
+        }
+
+        if (slot == NULL) {
+            pthread_cond_wait(&prefetch->work, &prefetch->lock);
+            continue;
+        }
+
+        // The ui thread only marks loading slots cancelled and doesn't
+        // touch their parsers, so the page can be loaded without the lock
+        slot->state = PREFETCH_LOADING;
+        pthread_mutex_unlock(&prefetch->lock);
+
+        link_from_short_link(&slot->parser, slot->link);
+        loader_load_page(&prefetch->loader, &slot->parser);
+
+        pthread_mutex_lock(&prefetch->lock);
+        if (slot->state == PREFETCH_CANCELLED) {
+            slot->state = PREFETCH_EMPTY;
+            // The cancel was only meant for this load, unless quitting
+            if (!prefetch->quit)
+                loader_set_cancel(&prefetch->loader, false);
+            continue;
+        }
+
+        slot->state = PREFETCH_READY;
+        slot->loaded_at = time(NULL);
+    }
+    pthread_mutex_unlock(&prefetch->lock);
+
+    return NULL;
+}
+
+/**
+ * Settings like the disk cache are copied from the settings loader
+ */
+void init_prefetcher(prefetcher* prefetch, const page_loader* settings)
+{
+    prefetch->quit = false;
+    prefetch->slots = calloc(PREFETCH_SLOTS, sizeof(prefetch_slot));
+    for (size_t i = 0; i < PREFETCH_SLOTS; i++) {
+        prefetch->slots[i].state = PREFETCH_EMPTY;
+        init_html_parser(&prefetch->slots[i].parser);
+    }
+
+    init_page_loader(&prefetch->loader);
+    if (settings->cache_dir[0] != '\0')
+        loader_use_disk_cache(&prefetch->loader, settings->cache_dir);
+    loader_set_base_url(&prefetch->loader, settings->base_url);
+    loader_use_fetch(&prefetch->loader, settings->fetch, settings->fetch_data);
+    pthread_mutex_init(&prefetch->lock, NULL);
+    pthread_cond_init(&prefetch->work, NULL);
+    // Without the worker thread every page is just loaded on demand
+    prefetch->running = pthread_create(&prefetch->thread, NULL, prefetch_worker, prefetch) == 0;
+}
+
+void free_prefetcher(prefetcher* prefetch)
+{
+    pthread_mutex_lock(&prefetch->lock);
+    prefetch->quit = true;
+    // Abort the running load so quitting doesn't wait for the network
+    loader_set_cancel(&prefetch->loader, true);
+    pthread_cond_signal(&prefetch->work);
+    pthread_mutex_unlock(&prefetch->lock);
+
+    if (prefetch->running)
+        pthread_join(prefetch->thread, NULL);
+
+    pthread_cond_destroy(&prefetch->work);
+    pthread_mutex_destroy(&prefetch->lock);
+    free_page_loader(&prefetch->loader);
+
+    for (size_t i = 0; i < PREFETCH_SLOTS; i++)
+        free_html_parser(&prefetch->slots[i].parser);
+    free(prefetch->slots);
+}
+
+/**
+ * Queue the links for prefetching. Links that are already loaded or
+ * being loaded are kept, other slots are reused for the new links.
+ */
+void prefetch_links(prefetcher* prefetch, char** links, size_t count)
+{
+    if (!prefetch->running)
+        return;
+
+    pthread_mutex_lock(&prefetch->lock);
+    bool queued = false;
+    for (size_t i = 0; i < count; i++) {
+        prefetch_slot* slot = find_slot(prefetch, links[i]);
+        if (slot != NULL && !is_stale(slot))
+            continue;
+
+        // Find a slot that isn't needed for the wanted links
+        if (slot == NULL) {
+            for (size_t j = 0; j < PREFETCH_SLOTS; j++) {
+                prefetch_slot* candidate = &prefetch->slots[j];
+                if (candidate->state == PREFETCH_LOADING || candidate->state == PREFETCH_CANCELLED || is_wanted(candidate, links, count))
+                    continue;
+                slot = candidate;
+                break;
+            }
+        }
+
+        if (slot == NULL)
+            break;
+
+        memcpy(slot->link, links[i], HTML_LINK_SIZE);
+        slot->link[HTML_LINK_SIZE] = '\0';
+        slot->state = PREFETCH_QUEUED;
+        queued = true;
+    }
+
+    if (queued)
+        pthread_cond_signal(&prefetch->work);
+    pthread_mutex_unlock(&prefetch->lock);
+}
+
+/**
+ * Move the prefetched page for parser->link to the parser.
+ * A page that is still loading is cancelled instead of waited for,
+ * so the caller can load it with progress and cancelling.
+ * Returns false if the page has not been prefetched.
+ */
+bool prefetch_take(prefetcher* prefetch, html_parser* parser)
+{
+    if (!prefetch->running)
+        return false;
+
+    bool found = false;
+    pthread_mutex_lock(&prefetch->lock);
+    prefetch_slot* slot = find_slot(prefetch, parser->link);
+    if (slot != NULL && slot->state == PREFETCH_LOADING) {
+        // The worker frees the slot once the load has stopped
+        loader_set_cancel(&prefetch->loader, true);
+        slot->state = PREFETCH_CANCELLED;
+        pthread_mutex_unlock(&prefetch->lock);
+        return false;
+    }
+
+    if (slot != NULL && slot->state == PREFETCH_READY && !is_stale(slot) && !slot->parser.curl_load_error) {
+        // Swap the parsers so the slot gets the old page's memory to reuse
+        html_parser old = *parser;
+        *parser = slot->parser;
+        slot->parser = old;
+        // Both keep parsing the same sections as before
+        slot->parser.sections = parser->sections;
+        parser->sections = old.sections;
+        found = true;
+    }
+
+    // Queued links are loaded by the caller instead
+    if (slot != NULL)
+        slot->state = PREFETCH_EMPTY;
+    pthread_mutex_unlock(&prefetch->lock);
+
+    return found;
+}
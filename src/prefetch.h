@@ -0,0 +1,53 @@
+#ifndef _PREFETCH_H_
+#define _PREFETCH_H_
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <tekstitv.h>
+#include <time.h>
+
+// Previous and next (sub) pages and the highlighted link
+#define PREFETCH_LINKS 5
+// Extra slots so the loads that are still running don't block new ones
+#define PREFETCH_SLOTS 8
+// Prefetched pages older than this are loaded again
+#define PREFETCH_MAX_AGE 60
+
+typedef enum {
+    PREFETCH_EMPTY,
+    PREFETCH_QUEUED,
+    PREFETCH_LOADING,
+    // Still loading, but the page is thrown away when the load ends
+    PREFETCH_CANCELLED,
+    PREFETCH_READY,
+} prefetch_state;
+
+typedef struct {
+    prefetch_state state;
+    char link[HTML_LINK_SIZE + 1];
+    time_t loaded_at;
+    html_parser parser;
+} prefetch_slot;
+
+/**
+ * Worker thread that loads and parses the pages the user is
+ * likely to open next, while the current page is being read.
+ */
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    // Signaled when new links are queued
+    pthread_cond_t work;
+    bool quit;
+    bool running;
+    // Worker has its own loader since curl handles can't be shared between threads
+    page_loader loader;
+    prefetch_slot* slots;
+} prefetcher;
+
+void init_prefetcher(prefetcher* prefetch, const page_loader* settings);
+void free_prefetcher(prefetcher* prefetch);
+void prefetch_links(prefetcher* prefetch, char** links, size_t count);
+bool prefetch_take(prefetcher* prefetch, html_parser* parser);
+
+#endif
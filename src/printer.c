@@ -4,15 +4,15 @@
 #include "config.h"
 #include "printer.h"
 
-void print_time(int pre_padding)
+static void print_time(const config* conf, int pre_padding)
 {
-    if (global_config.time_fmt == NULL)
+    if (conf->time_fmt == NULL)
         return;
 
-    fmt_time ctime = current_time();
+    fmt_time ctime = current_time(conf);
 
     // +4 because the middle prints get 4 spaces for padding
-    size_t padding_len = MIDDLE_TEXT_MAX_LEN - pre_padding - ctime.time_len + 4;
+    size_t padding_len = MIDDLE_TEXT_MAX_LEN - pre_padding - utf8_text_width(ctime.time, ctime.time_len) + 4;
     for (size_t ii = 0; ii < padding_len; ii++) {
         putc(' ', stdout);
     }
@@ -20,20 +20,20 @@ void print_time(int pre_padding)
     printf("%s\n", ctime.time);
 }
 
-void print_title(html_parser* parser)
+static void print_title(const config* conf, html_parser* parser)
 {
-    if (global_config.no_title) {
+    if (conf->no_title) {
         // Take the prepadding from the title print into account
-        print_time(-2);
+        print_time(conf, -2);
     } else {
         printf("  %s", parser->title.text);
-        print_time(parser->title.size);
+        print_time(conf, parser->title.width);
     }
 }
 
-void print_middle(html_parser* parser)
+static void print_middle(const config* conf, html_parser* parser)
 {
-    if (global_config.no_middle)
+    if (conf->no_middle)
         return;
 
     html_item_type last_type = HTML_TEXT;
@@ -57,13 +57,17 @@ void print_middle(html_parser* parser)
     printf("\n");
 }
 
-void print_parser(html_parser* parser)
+void print_parser(const config* conf, html_parser* parser)
 {
     if (parser->curl_load_error) {
         printf("Couldn't load the page. Try another one\n");
         return;
     }
 
-    print_title(parser);
-    print_middle(parser);
+    // Keep stdout as the plain page for scripts
+    if (parser->stale)
+        fprintf(stderr, "Couldn't load the page, showing a cached copy\n");
+
+    print_title(conf, parser);
+    print_middle(conf, parser);
 }
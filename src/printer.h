@@ -3,6 +3,8 @@
 
 #include <tekstitv.h>
 
-void print_parser(html_parser* parser);
+#include "config.h"
+
+void print_parser(const config* conf, html_parser* parser);
 
 #endif
@@ -21,6 +21,9 @@ OPTION_LIST="
 --no-sub-page
 --default-colors
 --show-time
+--cache-size
+--cache-ttl
+--no-disk-cache
 "
 
 # Is _filedir declared
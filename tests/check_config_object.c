@@ -149,10 +149,13 @@ config gen_default_config(void)
         .no_middle = false,
         .no_sub_page = false,
         .default_colors = false,
+        .no_disk_cache = false,
         .bg_rgb = { -1, -1, -1 },
         .text_rgb = { -1, -1, -1 },
         .link_rgb = { -1, -1, -1 },
-        .time_fmt = NULL
+        .time_fmt = NULL,
+        .cache_size = 32,
+        .cache_ttl = 300
     };
     return tmp;
 }
@@ -189,7 +192,10 @@ bool equal_configs(config* conf, config* conf2)
         && conf->help_config == conf2->help_config
         && conf->no_bottom_nav == conf2->no_bottom_nav
         && conf->default_colors == conf2->default_colors
-        && conf->long_navigation == conf2->long_navigation;
+        && conf->no_disk_cache == conf2->no_disk_cache
+        && conf->long_navigation == conf2->long_navigation
+        && conf->cache_size == conf2->cache_size
+        && conf->cache_ttl == conf2->cache_ttl;
 }
 
 bool equal_to_global_config(config* conf)
@@ -330,8 +336,8 @@ START_TEST(all_cli_args_success_tests)
     reset_global_config();
     // don't use --config since it tries to open a file
     // First arg gets ignored since it's the programs name
-    char* tmp[] = { "", "--help", "123", "2", "--text-only", "--help-config", "--version", "--bg-color", "ffffff", "--text-color", "ffffff", "--link-color", "ffffff", "--navigation", "--long-navigation", "--no-nav", "--no-top-nav", "--no-bottom-nav", "--no-title", "--no-middle", "--no-sub-page", "--default-colors", "--show-time", "%d.%m. %H:%M:%S" };
-    init_config(24, tmp);
+    char* tmp[] = { "", "--help", "123", "2", "--text-only", "--help-config", "--version", "--bg-color", "ffffff", "--text-color", "ffffff", "--link-color", "ffffff", "--navigation", "--long-navigation", "--no-nav", "--no-top-nav", "--no-bottom-nav", "--no-title", "--no-middle", "--no-sub-page", "--default-colors", "--show-time", "%d.%m. %H:%M:%S", "--cache-size", "8", "--cache-ttl", "0", "--no-disk-cache" };
+    init_config(29, tmp);
     short trbg[3] = { 1000, 1000, 1000 };
     config conf = gen_default_config();
     conf.page = 123;
@@ -349,10 +355,13 @@ START_TEST(all_cli_args_success_tests)
     conf.no_middle = true;
     conf.no_sub_page = true;
     conf.default_colors = true;
+    conf.no_disk_cache = true;
     memcpy(conf.bg_rgb, trbg, sizeof(trbg));
     memcpy(conf.text_rgb, trbg, sizeof(trbg));
     memcpy(conf.link_rgb, trbg, sizeof(trbg));
     conf.time_fmt = "%d.%m. %H:%M:%S";
+    conf.cache_size = 8;
+    conf.cache_ttl = 0;
     ck_assert_int_eq(equal_to_global_config(&conf), true);
 }
 END_TEST
@@ -380,6 +389,8 @@ START_TEST(cli_arg_errors)
     COLOR_ARG_ERR("--bg-color", "b324tar");
     COLOR_ARG_ERR("--text-color", "b123");
     COLOR_ARG_ERR("--link-color", "b1k");
+    COLOR_ARG_ERR("--cache-size", "-1");
+    COLOR_ARG_ERR("--cache-ttl", "10s");
     ck_assert_int_eq(global_config.page, 1);
 }
 END_TEST
@@ -426,11 +437,14 @@ START_TEST(config_file_parsing_tests)
     all.no_middle = true;
     all.no_sub_page = true;
     all.default_colors = true;
+    all.no_disk_cache = true;
     short abg[] = { 1000, 0, 0 }, atext[] = { 0, 1000, 0 }, alink[] = { 0, 0, 1000 };
     memcpy(all.bg_rgb, abg, sizeof(short) * 3);
     memcpy(all.text_rgb, atext, sizeof(short) * 3);
     memcpy(all.link_rgb, alink, sizeof(short) * 3);
     all.time_fmt = "%d.%m. %H:%M";
+    all.cache_size = 8;
+    all.cache_ttl = 0;
     // Succesful options should be first in the config file, this way
     // we can ignore config equality in invalid configs
     config result_configs[] = {
@@ -0,0 +1,170 @@
+#include <check.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <tekstitv.h>
+#include <unistd.h>
+
+#include "../src/page_cache.h"
+
+static html_parser source;
+
+static void load_source(void)
+{
+    int fd = open("tests/test_html/100.htm", O_RDONLY);
+    struct stat fs;
+    fstat(fd, &fs);
+
+    char* html = malloc(fs.st_size);
+    read(fd, html, fs.st_size);
+    init_html_parser(&source);
+    html_buffer_append(&source._curl_buffer, html, fs.st_size);
+    parse_html(&source);
+    free(html);
+    close(fd);
+}
+
+// Cache the source page as the page number
+static void put_page(page_cache* cache, int page)
+{
+    link_from_ints(&source, page, 1);
+    page_cache_put(cache, &source);
+}
+
+static bool has_page(page_cache* cache, int page)
+{
+    html_parser parser;
+    init_html_parser(&parser);
+    link_from_ints(&parser, page, 1);
+    bool found = page_cache_contains(cache, parser.link);
+    free_html_parser(&parser);
+    return found;
+}
+
+START_TEST(page_cache_eviction_test)
+{
+    load_source();
+    page_cache cache;
+    init_page_cache(&cache, 2, 0);
+
+    // Oldest page is dropped when the cache is full
+    put_page(&cache, 100);
+    put_page(&cache, 101);
+    put_page(&cache, 102);
+    ck_assert_int_eq(cache.size, 2);
+    ck_assert_int_eq(has_page(&cache, 100), false);
+    ck_assert_int_eq(has_page(&cache, 101), true);
+    ck_assert_int_eq(has_page(&cache, 102), true);
+
+    // Getting a page makes it the most recently used
+    html_parser parser;
+    init_html_parser(&parser);
+    link_from_ints(&parser, 101, 1);
+    ck_assert_int_eq(page_cache_get(&cache, &parser), true);
+    put_page(&cache, 103);
+    ck_assert_int_eq(has_page(&cache, 101), true);
+    ck_assert_int_eq(has_page(&cache, 102), false);
+    ck_assert_int_eq(has_page(&cache, 103), true);
+
+    free_html_parser(&parser);
+    free_page_cache(&cache);
+    free_html_parser(&source);
+}
+END_TEST
+
+START_TEST(page_cache_ttl_test)
+{
+    load_source();
+    page_cache cache;
+    init_page_cache(&cache, 4, 60);
+
+    put_page(&cache, 100);
+    put_page(&cache, 101);
+    ck_assert_int_eq(has_page(&cache, 100), true);
+
+    // Expired pages miss and are removed
+    cache.entries[0].loaded_at -= 61;
+    html_parser parser;
+    init_html_parser(&parser);
+    link_from_ints(&parser, 100, 1);
+    ck_assert_int_eq(page_cache_get(&cache, &parser), false);
+    ck_assert_int_eq(cache.size, 1);
+    ck_assert_int_eq(has_page(&cache, 101), true);
+
+    free_html_parser(&parser);
+    free_page_cache(&cache);
+    free_html_parser(&source);
+}
+END_TEST
+
+START_TEST(page_cache_copy_test)
+{
+    load_source();
+    page_cache cache;
+    init_page_cache(&cache, 2, 0);
+    put_page(&cache, 100);
+    // Changing the put page doesn't change the cached copy
+    strcpy(source.title.text, "changed");
+
+    html_parser parser;
+    init_html_parser(&parser);
+    link_from_ints(&parser, 100, 1);
+    ck_assert_int_eq(page_cache_get(&cache, &parser), true);
+    ck_assert_str_eq(parser.title.text, "Yle Teksti-TV | Sivu 100.1 ");
+    ck_assert_int_eq(parser.middle_rows, 25);
+    ck_assert_ptr_ne(parser.middle, cache.entries[0].parser.middle);
+
+    // Neither does changing the returned page
+    strcpy(parser.title.text, "changed");
+    parser.middle[0].size = 0;
+    html_parser other;
+    init_html_parser(&other);
+    link_from_ints(&other, 100, 1);
+    ck_assert_int_eq(page_cache_get(&cache, &other), true);
+    ck_assert_str_eq(other.title.text, "Yle Teksti-TV | Sivu 100.1 ");
+    ck_assert_int_eq(other.middle[0].size, cache.entries[0].parser.middle[0].size);
+
+    // Returned page outlives the cache
+    free_page_cache(&cache);
+    ck_assert_int_eq(other.middle_rows, 25);
+    ck_assert_str_eq(other.middle[23].items[1].item.link.url.text, "811_0001.htm");
+
+    free_html_parser(&other);
+    free_html_parser(&parser);
+    free_html_parser(&source);
+}
+END_TEST
+
+Suite* page_cache_suite(void)
+{
+    Suite* s;
+    TCase* tc_core;
+
+    s = suite_create("Page cache");
+    tc_core = tcase_create("Page cache Core");
+
+    tcase_add_test(tc_core, page_cache_eviction_test);
+    tcase_add_test(tc_core, page_cache_ttl_test);
+    tcase_add_test(tc_core, page_cache_copy_test);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite* s;
+    SRunner* sr;
+
+    s = page_cache_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,10 +1,17 @@
+#define _POSIX_C_SOURCE 200809L
 #include <check.h>
 #include <fcntl.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <tekstitv.h>
 #include <unistd.h>
 
+#include "../lib/disk_cache.h"
+#include "../lib/html_arena.h"
+#include "../lib/html_scan.h"
+
 #define top_i(_i) (parser.top_navigation[_i])
 #define top_t(_i) (html_item_as_text(top_i(_i)))
 #define top_l(_i) (html_item_as_link(top_i(_i)))
@@ -37,12 +44,13 @@ void load_page_helper(html_parser* parser, const char* file_name)
     struct stat fs;
     fstat(fd, &fs);
 
-    read(fd, parser->_curl_buffer.html, fs.st_size);
-    parser->_curl_buffer.html[fs.st_size] = '\0';
+    char* html = malloc(fs.st_size);
+    read(fd, html, fs.st_size);
     parser->_curl_buffer.current = 0;
     parser->_curl_buffer.size = 0;
-    parser->_curl_buffer.size = fs.st_size;
+    html_buffer_append(&parser->_curl_buffer, html, fs.st_size);
     parser->curl_load_error = false;
+    free(html);
     close(fd);
 }
 
@@ -50,11 +58,14 @@ START_TEST(parse_html_test_page_100)
 {
     html_parser parser;
     init_html_parser(&parser);
-    load_page_helper(&parser, "tests/test_html/100.htm");
-    parse_html(&parser);
+    ck_assert_int_eq(parse_html_file(&parser, "tests/test_html/100.htm"), true);
+    ck_assert_int_eq(parser.curl_load_error, false);
+    // The file is parsed without reading it to the parser's buffer
+    ck_assert_int_eq(parser._curl_buffer.size, 0);
 
     // Title test
     ck_assert_int_eq(parser.title.size, 27);
+    ck_assert_int_eq(parser.title.width, 27);
     ck_assert_str_eq(parser.title.text, "Yle Teksti-TV | Sivu 100.1 ");
     // Top nav test
     ck_assert_int_eq(top_i(0).type, HTML_TEXT);
@@ -141,6 +152,7 @@ START_TEST(parse_html_test_page_100)
     m_text(4, 2, 4, "    ");
     m_link(4, 3, "199_0001.htm", 3, "199");
     m_text(4, 4, 15, " PÄÄHAKEMISTO");
+    ck_assert_int_eq(parser.middle[4].items[4].item.text.width, 13);
     m_empty(5);
     m_size(6, 5);
     m_text(6, 0, 2, "  ");
@@ -153,6 +165,7 @@ START_TEST(parse_html_test_page_100)
     m_text(8, 0, 2, "  ");
     m_link(8, 1, "106_0001.htm", 3, "106");
     m_text(8, 2, 17, " Jyväskylässä ");
+    ck_assert_int_eq(parser.middle[8].items[2].item.text.width, 14);
     m_link(8, 3, "500_0001.htm", 3, "500");
     m_text(8, 4, 13, " karanteeniin");
     m_empty(9);
@@ -219,6 +232,677 @@ START_TEST(parse_html_test_page_100)
 }
 END_TEST
 
+START_TEST(parse_html_buffer_test)
+{
+    html_parser source;
+    init_html_parser(&source);
+    load_page_helper(&source, "tests/test_html/100.htm");
+
+    // Exactly sized copy without the NUL terminator
+    size_t size = source._curl_buffer.size;
+    char* html = malloc(size);
+    memcpy(html, source._curl_buffer.html, size);
+    free_html_parser(&source);
+
+    html_parser parser;
+    init_html_parser(&parser);
+    parse_html_buffer(&parser, html, size);
+    free(html);
+
+    ck_assert_int_eq(parser.curl_load_error, false);
+    ck_assert_str_eq(parser.title.text, "Yle Teksti-TV | Sivu 100.1 ");
+    m_link(23, 1, "811_0001.htm", 3, "811");
+    ck_assert_int_eq(parser.sub_pages.size, 7);
+    ck_assert_str_eq(bot_t(5).text, "Teksti-TV");
+
+    // Parsing again replaces the earlier page
+    parse_html_buffer(&parser, "<html><title>YLE Teleport</title></html>", 40);
+    ck_assert_int_eq(parser.curl_load_error, true);
+    ck_assert_int_eq(parser.middle_rows, 0);
+
+    ck_assert_int_eq(parse_html_file(&parser, "tests/test_html/missing.htm"), false);
+    ck_assert_int_eq(parser.curl_load_error, true);
+
+    free_html_parser(&parser);
+}
+END_TEST
+
+START_TEST(parse_html_dense_page_test)
+{
+    html_parser parser;
+    init_html_parser(&parser);
+
+    // More rows and links than the old fixed 32 x 16 limits, and too long texts
+    html_buffer_append(&parser._curl_buffer, "<TITLE>x</TITLE><p><big>Dense</big></p>", 39);
+    html_buffer_append(&parser._curl_buffer, "<SPAN>a&nbsp;|&nbsp;b&nbsp;|&nbsp;c&nbsp;|&nbsp;d</SPAN><DIV><pre>\n", 67);
+    for (size_t row = 0; row < 40; row++) {
+        html_buffer_append(&parser._curl_buffer, " ", 1);
+        for (size_t link = 0; link < 20; link++)
+            html_buffer_append(&parser._curl_buffer, "<a href=\"100_0001.htm\">100</a> ", 32);
+        html_buffer_append(&parser._curl_buffer, "\n", 1);
+    }
+    const char* long_text = " 0123456789012345678901234567890123456789012345678901234567890123456789\n";
+    html_buffer_append(&parser._curl_buffer, long_text, strlen(long_text));
+    html_buffer_append(&parser._curl_buffer, "</pre></DIV>", 12);
+    parse_html(&parser);
+
+    ck_assert_str_eq(parser.title.text, "Dense");
+    ck_assert_int_eq(parser.middle_rows, 42);
+    m_empty(0);
+    // Leading space and a text item after every link
+    m_size(40, 41);
+    m_link(40, 1, "100_0001.htm", 3, "100");
+    m_link(40, 39, "100_0001.htm", 3, "100");
+    // Texts that don't fit are cut
+    ck_assert_int_eq(parser.middle[41].items[0].item.text.size, HTML_TEXT_MAX - 1);
+
+    free_html_parser(&parser);
+}
+END_TEST
+
+START_TEST(parse_html_partial_test_page_100)
+{
+    html_parser parser;
+    init_html_parser(&parser);
+    load_page_helper(&parser, "tests/test_html/100.htm");
+    size_t page_size = parser._curl_buffer.size;
+
+    // Nothing can be parsed before the title is loaded
+    parser._curl_buffer.size = 100;
+    ck_assert_int_eq(parse_html_partial(&parser, false), false);
+    ck_assert_int_eq(parser.parsed, HTML_SECTION_NONE);
+
+    // Simulate the page arriving in small chunks
+    for (size_t size = 100; size < page_size; size += 64) {
+        parser._curl_buffer.size = size;
+        parse_html_partial(&parser, false);
+        // Rest of the page is only parsed after the load has finished
+        ck_assert_int_ne(parser.parsed, HTML_SECTION_ALL);
+    }
+
+    ck_assert_int_eq(parser.parsed, HTML_SECTION_MIDDLE);
+    ck_assert_str_eq(parser.title.text, "Yle Teksti-TV | Sivu 100.1 ");
+    ck_assert_str_eq(top_l(3).url.text, "101_0001.htm");
+    m_link(23, 1, "811_0001.htm", 3, "811");
+
+    parser._curl_buffer.size = page_size;
+    parse_html(&parser);
+    ck_assert_int_eq(parser.parsed, HTML_SECTION_ALL);
+    ck_assert_int_eq(parser.curl_load_error, false);
+    ck_assert_int_eq(parser.sub_pages.size, 7);
+    ck_assert_str_eq(bot_t(5).text, "Teksti-TV");
+
+    free_html_parser(&parser);
+}
+END_TEST
+
+// Copy the spanned text with its pre spaces so it can be compared as a string
+static const char* view_text(const html_page_view* view, const html_item_view* item, bool url)
+{
+    static char text[1024];
+    size_t pre_space = url ? 0 : item->pre_space;
+    html_span span = url ? item->url : item->text;
+    memset(text, ' ', pre_space);
+    memcpy(text + pre_space, html_span_text(view, span), span.size);
+    text[pre_space + span.size] = '\0';
+    return text;
+}
+
+static void assert_view_item(const html_page_view* view, const html_item_view* item, html_item expected)
+{
+    ck_assert_int_eq(item->type, expected.type);
+    if (expected.type == HTML_TEXT) {
+        ck_assert_str_eq(view_text(view, item, false), expected.item.text.text);
+    } else {
+        ck_assert_str_eq(view_text(view, item, true), expected.item.link.url.text);
+        ck_assert_str_eq(view_text(view, item, false), expected.item.link.inner_text.text);
+    }
+}
+
+START_TEST(parse_html_sections_test)
+{
+    html_parser parser;
+    init_html_parser(&parser);
+    ck_assert_int_eq(parser.sections, HTML_PARSE_ALL);
+
+    // Only the middle rows
+    parser.sections = HTML_PARSE_MIDDLE;
+    ck_assert_int_eq(parse_html_file(&parser, "tests/test_html/100.htm"), true);
+    ck_assert_int_eq(parser.curl_load_error, false);
+    ck_assert_int_eq(parser.parsed, HTML_SECTION_ALL);
+    ck_assert_int_eq(parser.title.size, 0);
+    ck_assert_int_eq(top_t(0).size, 0);
+    m_link(23, 1, "811_0001.htm", 3, "811");
+    ck_assert_int_eq(parser.sub_pages.size, 0);
+    ck_assert_int_eq(bot_t(5).size, 0);
+
+    // Sections after the middle are found when the middle is skipped.
+    // The mask is kept when the parser is reset for the next page.
+    parser.sections = HTML_PARSE_SUB_PAGES | HTML_PARSE_BOTTOM_NAVIGATION;
+    reset_html_parser(&parser);
+    ck_assert_int_eq(parser.sections, HTML_PARSE_SUB_PAGES | HTML_PARSE_BOTTOM_NAVIGATION);
+    parse_html_file(&parser, "tests/test_html/100.htm");
+    ck_assert_int_eq(parser.middle_rows, 0);
+    ck_assert_int_eq(parser.sub_pages.size, 7);
+    ck_assert_str_eq(sub_l(5).url.text, "100_0004.htm");
+    ck_assert_str_eq(bot_t(5).text, "Teksti-TV");
+
+    // Nothing after the title is waited for
+    parser.sections = HTML_PARSE_TITLE;
+    reset_html_parser(&parser);
+    load_page_helper(&parser, "tests/test_html/100.htm");
+    parser._curl_buffer.size = strstr(parser._curl_buffer.html, "</big>") - parser._curl_buffer.html + 6;
+    ck_assert_int_eq(parse_html_partial(&parser, false), true);
+    ck_assert_int_eq(parser.parsed, HTML_SECTION_ALL);
+    ck_assert_str_eq(parser.title.text, "Yle Teksti-TV | Sivu 100.1 ");
+    ck_assert_int_eq(parser.middle_rows, 0);
+
+    // Invalid pages are still found with an empty mask
+    parser.sections = 0;
+    parse_html_buffer(&parser, "<html><title>YLE Teleport</title></html>", 40);
+    ck_assert_int_eq(parser.curl_load_error, true);
+
+    free_html_parser(&parser);
+}
+END_TEST
+
+START_TEST(parse_html_page_view_test_page_100)
+{
+    html_parser parser;
+    init_html_parser(&parser);
+    load_page_helper(&parser, "tests/test_html/100.htm");
+    parse_html(&parser);
+
+    html_page_view view;
+    init_html_page_view(&view);
+    const html_buffer* page = &parser._curl_buffer;
+    ck_assert_int_eq(parse_html_page_view(&view, page->html, page->size), true);
+    ck_assert_int_eq(view.invalid, false);
+
+    // Plain texts point straight to the page html
+    ck_assert_int_eq(view.title.decoded, false);
+    ck_assert_ptr_eq(html_span_text(&view, view.title), strstr(page->html, "Yle Teksti-TV | Sivu 100.1 "));
+    ck_assert_int_eq(view.title.size, 27);
+
+    // Texts with entities are decoded to the side buffer
+    const html_item_view* row = html_row_view_items(&view, view.middle[4]);
+    ck_assert_int_eq(row[4].text.decoded, true);
+    ck_assert_str_eq(view_text(&view, &row[4], false), " PÄÄHAKEMISTO");
+
+    // Everything else matches the copying parser
+    for (size_t i = 0; i < TOP_NAVIGATION_SIZE; i++)
+        assert_view_item(&view, &view.top_navigation[i], parser.top_navigation[i]);
+    for (size_t i = 0; i < BOTTOM_NAVIGATION_SIZE; i++) {
+        html_item expected = { .type = HTML_LINK, .item.link = parser.bottom_navigation[i] };
+        assert_view_item(&view, &view.bottom_navigation[i], expected);
+    }
+
+    ck_assert_int_eq(view.middle_rows, parser.middle_rows);
+    for (size_t r = 0; r < view.middle_rows; r++) {
+        ck_assert_int_eq(view.middle[r].size, parser.middle[r].size);
+        for (size_t i = 0; i < view.middle[r].size; i++)
+            assert_view_item(&view, html_row_view_items(&view, view.middle[r]) + i, parser.middle[r].items[i]);
+    }
+
+    ck_assert_int_eq(view.sub_pages.size, parser.sub_pages.size);
+    for (size_t i = 0; i < view.sub_pages.size; i++)
+        assert_view_item(&view, html_row_view_items(&view, view.sub_pages) + i, parser.sub_pages.items[i]);
+
+    free_html_page_view(&view);
+    free_html_parser(&parser);
+}
+END_TEST
+
+START_TEST(page_loader_transport_test)
+{
+    html_parser source;
+    init_html_parser(&source);
+    load_page_helper(&source, "tests/test_html/100.htm");
+
+    page_memory_entry entries[] = {
+        { "100_0001.htm", source._curl_buffer.html, source._curl_buffer.size },
+    };
+    page_memory_map map = { entries, 1, 0 };
+
+    page_loader loader;
+    init_page_loader(&loader);
+    ck_assert_str_eq(loader.base_url, PAGE_LOADER_DEFAULT_BASE_URL);
+    loader_use_fetch(&loader, page_memory_fetch, &map);
+
+    html_parser parser;
+    init_html_parser(&parser);
+    link_from_ints(&parser, 100, 1);
+    loader_load_page(&loader, &parser);
+    ck_assert_int_eq(parser.curl_load_error, false);
+    ck_assert_str_eq(parser.title.text, "Yle Teksti-TV | Sivu 100.1 ");
+    m_link(23, 1, "811_0001.htm", 3, "811");
+
+    // Pages that are not in the map fail like missing pages
+    link_from_ints(&parser, 101, 1);
+    loader_load_page(&loader, &parser);
+    ck_assert_int_eq(parser.curl_load_error, true);
+
+    // Same page from a directory with curl
+    char dir[] = "/tmp/tekstitv-test-XXXXXX";
+    ck_assert_ptr_ne(mkdtemp(dir), NULL);
+    char path[PAGE_LOADER_URL_MAX];
+    snprintf(path, sizeof(path), "%s/100_0001.htm", dir);
+    FILE* fp = fopen(path, "w");
+    fwrite(source._curl_buffer.html, 1, source._curl_buffer.size, fp);
+    fclose(fp);
+
+    char url[PAGE_LOADER_URL_MAX];
+    snprintf(url, sizeof(url), "file://%s/", dir);
+    loader_use_fetch(&loader, NULL, NULL);
+    ck_assert_int_eq(loader_set_base_url(&loader, url), true);
+    link_from_ints(&parser, 100, 1);
+    loader_load_page(&loader, &parser);
+    ck_assert_int_eq(parser.curl_load_error, false);
+    ck_assert_str_eq(parser.title.text, "Yle Teksti-TV | Sivu 100.1 ");
+
+    link_from_ints(&parser, 101, 1);
+    loader_load_page(&loader, &parser);
+    ck_assert_int_eq(parser.curl_load_error, true);
+
+    // Pages over the limit fail with the limit in the message
+    loader.max_page_size = 100;
+    link_from_ints(&parser, 100, 1);
+    loader_load_page(&loader, &parser);
+    ck_assert_int_eq(parser.curl_load_error, true);
+    ck_assert_str_eq(loader.error, "Page is larger than the 100 byte limit");
+
+    unlink(path);
+    rmdir(dir);
+    free_page_loader(&loader);
+    free_html_parser(&parser);
+    free_html_parser(&source);
+}
+END_TEST
+
+START_TEST(load_page_batch_test)
+{
+    html_parser source;
+    init_html_parser(&source);
+    load_page_helper(&source, "tests/test_html/100.htm");
+
+    // More pages than transfers, so the handles are reused
+    char* links[] = { "100_0001.htm", "101_0001.htm", "102_0001.htm", "100_0001.htm", "103_0001.htm" };
+    const bool missing[] = { false, true, false, false, true };
+    const size_t count = sizeof(links) / sizeof(links[0]);
+    html_parser parsers[sizeof(links) / sizeof(links[0])];
+    for (size_t i = 0; i < count; i++)
+        init_html_parser(&parsers[i]);
+
+    page_memory_entry entries[] = {
+        { "100_0001.htm", source._curl_buffer.html, source._curl_buffer.size },
+        { "102_0001.htm", source._curl_buffer.html, source._curl_buffer.size },
+    };
+    page_memory_map map = { entries, 2, 0 };
+    page_batch_options options = { 0 };
+    options.max_concurrency = 2;
+    options.fetch = page_memory_fetch;
+    options.fetch_data = &map;
+    load_page_batch(options, links, parsers, count);
+    for (size_t i = 0; i < count; i++) {
+        ck_assert_int_eq(parsers[i].curl_load_error, missing[i]);
+        if (!missing[i])
+            ck_assert_str_eq(parsers[i].title.text, "Yle Teksti-TV | Sivu 100.1 ");
+    }
+
+    // Same pages from a directory with curl
+    char dir[] = "/tmp/tekstitv-test-XXXXXX";
+    ck_assert_ptr_ne(mkdtemp(dir), NULL);
+    char paths[2][PAGE_LOADER_URL_MAX];
+    for (size_t i = 0; i < 2; i++) {
+        snprintf(paths[i], sizeof(paths[i]), "%s/%s", dir, entries[i].link);
+        FILE* fp = fopen(paths[i], "w");
+        fwrite(source._curl_buffer.html, 1, source._curl_buffer.size, fp);
+        fclose(fp);
+    }
+
+    char url[PAGE_LOADER_URL_MAX];
+    snprintf(url, sizeof(url), "file://%s/", dir);
+    options.fetch = NULL;
+    options.fetch_data = NULL;
+    options.base_url = url;
+    load_page_batch(options, links, parsers, count);
+    for (size_t i = 0; i < count; i++) {
+        ck_assert_str_eq(parsers[i].link, links[i]);
+        ck_assert_int_eq(parsers[i].curl_load_error, missing[i]);
+        if (!missing[i])
+            ck_assert_str_eq(parsers[i].title.text, "Yle Teksti-TV | Sivu 100.1 ");
+    }
+
+    for (size_t i = 0; i < 2; i++)
+        unlink(paths[i]);
+    rmdir(dir);
+    for (size_t i = 0; i < count; i++)
+        free_html_parser(&parsers[i]);
+    free_html_parser(&source);
+}
+END_TEST
+
+START_TEST(disk_cache_link_test)
+{
+    char dir[] = "/tmp/tekstitv-test-XXXXXX";
+    ck_assert_ptr_ne(mkdtemp(dir), NULL);
+    char sub_dir[PAGE_LOADER_PATH_MAX];
+    snprintf(sub_dir, sizeof(sub_dir), "%s/cache", dir);
+    ck_assert_int_eq(disk_cache_create_dir(sub_dir), true);
+
+    html_buffer buffer = { 0 };
+    buffer.limit = HTML_BUFFER_DEFAULT_LIMIT;
+    html_buffer_append(&buffer, "<html>", 6);
+    cache_validators validators = { .etag = "\"1\"", .last_modified = "" };
+
+    disk_cache_write_page(sub_dir, "100_0001.htm", &validators, &buffer);
+    ck_assert_int_eq(disk_cache_read_page(sub_dir, "100_0001.htm", &buffer), true);
+    ck_assert_int_eq(buffer.size, 6);
+
+    // Links that are not page links never reach the file system
+    const char* bad_links[] = { "../100_1.htm", "100_0001.txt", "10a_0001.htm", "100/0001.htm" };
+    for (size_t i = 0; i < sizeof(bad_links) / sizeof(bad_links[0]); i++) {
+        disk_cache_write_page(sub_dir, bad_links[i], &validators, &buffer);
+        ck_assert_int_eq(disk_cache_read_validators(sub_dir, bad_links[i], &validators), false);
+        ck_assert_int_eq(disk_cache_read_page(sub_dir, bad_links[i], &buffer), false);
+    }
+    char escaped[PAGE_LOADER_PATH_MAX];
+    snprintf(escaped, sizeof(escaped), "%s/100_1.htm", dir);
+    ck_assert_int_eq(access(escaped, F_OK), -1);
+
+    char path[PAGE_LOADER_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/100_0001.htm", sub_dir);
+    unlink(path);
+    rmdir(sub_dir);
+    rmdir(dir);
+    free(buffer.html);
+}
+END_TEST
+
+START_TEST(disk_cache_stale_page_test)
+{
+    html_parser source;
+    init_html_parser(&source);
+    load_page_helper(&source, "tests/test_html/100.htm");
+
+    char dir[] = "/tmp/tekstitv-test-XXXXXX";
+    ck_assert_ptr_ne(mkdtemp(dir), NULL);
+    char cache_dir[PAGE_LOADER_PATH_MAX];
+    snprintf(cache_dir, sizeof(cache_dir), "%s/cache", dir);
+    ck_assert_int_eq(disk_cache_create_dir(cache_dir), true);
+
+    // Page and its validators are read back as they were written
+    cache_validators written = { .etag = "\"5f3a-1\"", .last_modified = "Mon, 01 Jan 2024 00:00:00 GMT" };
+    disk_cache_write_page(cache_dir, "100_0001.htm", &written, &source._curl_buffer);
+    cache_validators validators;
+    ck_assert_int_eq(disk_cache_read_validators(cache_dir, "100_0001.htm", &validators), true);
+    ck_assert_str_eq(validators.etag, written.etag);
+    ck_assert_str_eq(validators.last_modified, written.last_modified);
+
+    html_buffer buffer = { 0 };
+    buffer.limit = HTML_BUFFER_DEFAULT_LIMIT;
+    ck_assert_int_eq(disk_cache_read_page(cache_dir, "100_0001.htm", &buffer), true);
+    ck_assert_int_eq(buffer.size, source._curl_buffer.size);
+    ck_assert_int_eq(memcmp(buffer.html, source._curl_buffer.html, buffer.size), 0);
+
+    // The cached copy is shown when the page can't be loaded
+    char url[PAGE_LOADER_URL_MAX];
+    snprintf(url, sizeof(url), "file://%s/missing/", dir);
+    page_loader loader;
+    init_page_loader(&loader);
+    ck_assert_int_eq(loader_use_disk_cache(&loader, cache_dir), true);
+    ck_assert_int_eq(loader_set_base_url(&loader, url), true);
+
+    html_parser parser;
+    init_html_parser(&parser);
+    link_from_ints(&parser, 100, 1);
+    loader_load_page(&loader, &parser);
+    ck_assert_int_eq(parser.curl_load_error, false);
+    ck_assert_int_eq(parser.stale, true);
+    ck_assert_str_eq(parser.title.text, "Yle Teksti-TV | Sivu 100.1 ");
+
+    // Pages that were never cached still fail
+    link_from_ints(&parser, 101, 1);
+    loader_load_page(&loader, &parser);
+    ck_assert_int_eq(parser.curl_load_error, true);
+    ck_assert_int_eq(parser.stale, false);
+
+    char path[PAGE_LOADER_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/100_0001.htm", cache_dir);
+    unlink(path);
+    rmdir(cache_dir);
+    rmdir(dir);
+    free(buffer.html);
+    free_page_loader(&loader);
+    free_html_parser(&parser);
+    free_html_parser(&source);
+}
+END_TEST
+
+START_TEST(html_buffer_append_test)
+{
+    html_parser parser;
+    init_html_parser(&parser);
+    parser._curl_buffer.limit = 8;
+
+    ck_assert_int_eq(html_buffer_append(&parser._curl_buffer, "<p>", 3), true);
+    ck_assert_int_eq(html_buffer_append(&parser._curl_buffer, "text", 4), true);
+    ck_assert_str_eq(parser._curl_buffer.html, "<p>text");
+    // Limit is reached, the buffer stays as it was
+    ck_assert_int_eq(html_buffer_append(&parser._curl_buffer, "</p>", 4), false);
+    ck_assert_int_eq(parser._curl_buffer.size, 7);
+    ck_assert_str_eq(parser._curl_buffer.html, "<p>text");
+    ck_assert_int_eq(html_buffer_append(&parser._curl_buffer, "<", 1), true);
+    ck_assert_int_eq(parser._curl_buffer.size, 8);
+
+    free_html_parser(&parser);
+}
+END_TEST
+
+START_TEST(copy_html_parser_test)
+{
+    html_parser parser;
+    html_parser source;
+    init_html_parser(&parser);
+    init_html_parser(&source);
+    load_page_helper(&source, "tests/test_html/100.htm");
+    parse_html(&source);
+    ck_assert_int_eq(copy_html_parser(&parser, &source), true);
+    // Copying again reuses the arena of the target
+    html_row* middle = parser.middle;
+    ck_assert_int_eq(copy_html_parser(&parser, &source), true);
+    ck_assert_ptr_eq(parser.middle, middle);
+    // The copy has no html and only the arena memory the page needs
+    ck_assert_int_lt(html_parser_memory(&parser), html_parser_memory(&source));
+    ck_assert_int_gt(html_parser_memory(&parser), sizeof(html_parser));
+    free_html_parser(&source);
+
+    ck_assert_ptr_null(parser._curl_buffer.html);
+    ck_assert_str_eq(parser.title.text, "Yle Teksti-TV | Sivu 100.1 ");
+    ck_assert_int_eq(parser.middle_rows, 25);
+    m_link(23, 1, "811_0001.htm", 3, "811");
+    ck_assert_int_eq(parser.sub_pages.size, 7);
+    ck_assert_str_eq(sub_l(5).url.text, "100_0004.htm");
+
+    free_html_parser(&parser);
+}
+END_TEST
+
+START_TEST(reset_html_parser_test)
+{
+    html_parser parser;
+    init_html_parser(&parser);
+    load_page_helper(&parser, "tests/test_html/100.htm");
+    parse_html(&parser);
+    html_row* middle = parser.middle;
+    html_item* sub_pages = parser.sub_pages.items;
+    char* html = parser._curl_buffer.html;
+
+    reset_html_parser(&parser);
+    ck_assert_int_eq(parser.middle_rows, 0);
+    ck_assert_int_eq(parser.sub_pages.size, 0);
+    ck_assert_int_eq(parser.parsed, HTML_SECTION_NONE);
+    ck_assert_int_eq(parser.title.size, 0);
+    ck_assert_str_eq(parser.title.text, "");
+    ck_assert_int_eq(parser._curl_buffer.size, 0);
+
+    // Parsing the page again gives the same results with the same memory
+    load_page_helper(&parser, "tests/test_html/100.htm");
+    parse_html(&parser);
+    ck_assert_ptr_eq(parser.middle, middle);
+    ck_assert_ptr_eq(parser.sub_pages.items, sub_pages);
+    ck_assert_ptr_eq(parser._curl_buffer.html, html);
+    ck_assert_str_eq(parser.title.text, "Yle Teksti-TV | Sivu 100.1 ");
+    ck_assert_int_eq(parser.middle_rows, 25);
+    m_link(23, 1, "811_0001.htm", 3, "811");
+    ck_assert_int_eq(parser.sub_pages.size, 7);
+
+    free_html_parser(&parser);
+}
+END_TEST
+
+START_TEST(html_parser_pool_test)
+{
+    html_parser_pool pool;
+    init_html_parser_pool(&pool);
+
+    html_parser* first = html_parser_pool_take(&pool);
+    html_parser* second = html_parser_pool_take(&pool);
+    ck_assert_ptr_nonnull(first);
+    ck_assert_ptr_nonnull(second);
+    ck_assert_ptr_ne(first, second);
+
+    load_page_helper(first, "tests/test_html/100.htm");
+    parse_html(first);
+    html_parser_pool_give(&pool, first);
+    html_parser_pool_give(&pool, second);
+
+    // Latest returned parser is reused first, and it comes back reset
+    ck_assert_ptr_eq(html_parser_pool_take(&pool), second);
+    html_parser* parser = html_parser_pool_take(&pool);
+    ck_assert_ptr_eq(parser, first);
+    ck_assert_int_eq(parser->middle_rows, 0);
+    ck_assert_int_eq(parser->_curl_buffer.size, 0);
+
+    html_parser_pool_give(&pool, first);
+    html_parser_pool_give(&pool, second);
+    free_html_parser_pool(&pool);
+}
+END_TEST
+
+START_TEST(html_arena_test)
+{
+    html_arena arena;
+    init_html_arena(&arena);
+
+    char* first = html_arena_alloc(&arena, 10);
+    ck_assert_ptr_nonnull(first);
+    char* second = html_arena_alloc(&arena, 3);
+    ck_assert_int_eq((size_t)second % 16, 0);
+    ck_assert_int_ge(second - first, 10);
+
+    // Latest allocation grows in place, older ones are copied
+    memcpy(second, "ab", 3);
+    ck_assert_ptr_eq(html_arena_grow(&arena, second, 3, 100), second);
+    memcpy(first, "0123456789", 10);
+    char* moved = html_arena_grow(&arena, first, 10, 20);
+    ck_assert_ptr_ne(moved, first);
+    ck_assert_int_eq(memcmp(moved, "0123456789", 10), 0);
+
+    // Allocations larger than a block get their own block
+    char* large = html_arena_alloc(&arena, HTML_ARENA_BLOCK_SIZE * 4);
+    ck_assert_ptr_nonnull(large);
+    memset(large, 0, HTML_ARENA_BLOCK_SIZE * 4);
+    ck_assert_int_gt(html_arena_memory(&arena), HTML_ARENA_BLOCK_SIZE * 5);
+
+    // Memory is reused after the reset
+    html_arena_reset(&arena);
+    ck_assert_ptr_eq(html_arena_alloc(&arena, 10), first);
+    ck_assert_ptr_eq(html_arena_alloc(&arena, HTML_ARENA_BLOCK_SIZE * 4), large);
+
+    free_html_arena(&arena);
+    ck_assert_ptr_null(arena.first);
+}
+END_TEST
+
+static size_t naive_find_char2(const char* data, size_t len, char a, char b)
+{
+    for (size_t i = 0; i < len; i++) {
+        if (data[i] == a || data[i] == b)
+            return i;
+    }
+    return len;
+}
+
+static size_t naive_find_str(const char* data, size_t len, const char* str, size_t str_len)
+{
+    for (size_t i = 0; i + str_len <= len; i++) {
+        if (memcmp(data + i, str, str_len) == 0)
+            return i;
+    }
+    return len;
+}
+
+START_TEST(html_scan_test)
+{
+    const html_scanner* scanners[8];
+    size_t count = html_scan_supported(scanners, 8);
+    ck_assert_int_ge(count, 1);
+    ck_assert_str_eq(scanners[0]->name, "portable");
+    // Parser uses the fastest supported scanner
+    ck_assert_str_eq(html_scan.name, scanners[count - 1]->name);
+
+    // Around the 16 and 32 byte vectors, the data after len is never matched
+    size_t lengths[] = { 0, 1, 2, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100 };
+    const char* strs[] = { "<", "</", "</pre>", "&nbsp;|" };
+    char buffer[256];
+    for (size_t s = 0; s < count; s++) {
+        const html_scanner* scan = scanners[s];
+        for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+            size_t len = lengths[l];
+            for (size_t offset = 0; offset < 4; offset++) {
+                char* data = buffer + offset;
+                for (size_t pos = 0; pos <= len; pos++) {
+                    memset(buffer, '<', sizeof(buffer));
+                    memset(data, 'x', len);
+                    if (pos < len)
+                        data[pos] = '>';
+                    ck_assert_int_eq(scan->find_char(data, len, '>'), pos);
+                    ck_assert_int_eq(scan->find_char2(data, len, '>', '&'), naive_find_char2(data, len, '>', '&'));
+                    ck_assert_int_eq(scan->find_char2(data, len, '&', '>'), pos);
+
+                    for (size_t i = 0; i < sizeof(strs) / sizeof(strs[0]); i++) {
+                        size_t str_len = strlen(strs[i]);
+                        memset(data, 'x', len);
+                        // Also the partial matches that are cut by len
+                        if (pos < len)
+                            memcpy(data + pos, strs[i], pos + str_len <= len ? str_len : len - pos);
+                        ck_assert_int_eq(scan->find_str(data, len, strs[i], str_len), naive_find_str(data, len, strs[i], str_len));
+                    }
+                }
+            }
+        }
+    }
+}
+END_TEST
+
+START_TEST(utf8_text_width_test)
+{
+    ck_assert_int_eq(utf8_text_width("", 0), 0);
+    ck_assert_int_eq(utf8_text_width("Sivu 100", 8), 8);
+    // Two byte characters from both the latin-1 and the latin extended blocks
+    ck_assert_int_eq(utf8_text_width("Jyväskylä", 11), 9);
+    ck_assert_int_eq(utf8_text_width("\xc4\x8c\xc5\xa1", 4), 2);
+    // Combining acute accent
+    ck_assert_int_eq(utf8_text_width("e\xcc\x81", 3), 1);
+    // Wide characters
+    ck_assert_int_eq(utf8_text_width("\xe6\x97\xa5\xf0\x9f\x98\x80", 7), 4);
+    // Invalid and truncated sequences take a column per byte
+    ck_assert_int_eq(utf8_text_width("\xff\x80", 2), 2);
+    ck_assert_int_eq(utf8_text_width("a\xc3", 2), 2);
+}
+END_TEST
+
 START_TEST(link_from_ints_test)
 {
     html_parser parser;
@@ -289,6 +973,22 @@ Suite* parser_suite(void)
     tc_core = tcase_create("Html Parser Core");
 
     tcase_add_test(tc_core, parse_html_test_page_100);
+    tcase_add_test(tc_core, parse_html_buffer_test);
+    tcase_add_test(tc_core, parse_html_dense_page_test);
+    tcase_add_test(tc_core, parse_html_partial_test_page_100);
+    tcase_add_test(tc_core, parse_html_sections_test);
+    tcase_add_test(tc_core, parse_html_page_view_test_page_100);
+    tcase_add_test(tc_core, page_loader_transport_test);
+    tcase_add_test(tc_core, load_page_batch_test);
+    tcase_add_test(tc_core, disk_cache_link_test);
+    tcase_add_test(tc_core, disk_cache_stale_page_test);
+    tcase_add_test(tc_core, html_buffer_append_test);
+    tcase_add_test(tc_core, copy_html_parser_test);
+    tcase_add_test(tc_core, html_arena_test);
+    tcase_add_test(tc_core, reset_html_parser_test);
+    tcase_add_test(tc_core, html_parser_pool_test);
+    tcase_add_test(tc_core, html_scan_test);
+    tcase_add_test(tc_core, utf8_text_width_test);
     tcase_add_test(tc_core, link_from_ints_test);
     tcase_add_test(tc_core, link_from_short_link_test);
     tcase_add_test(tc_core, page_number_test);
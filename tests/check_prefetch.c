@@ -0,0 +1,194 @@
+#define _POSIX_C_SOURCE 200809L
+#include <check.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <tekstitv.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../src/prefetch.h"
+
+static html_parser source;
+static page_memory_entry entries[1];
+static page_memory_map map = { entries, 1, 0 };
+static page_loader settings;
+
+static void load_source(void)
+{
+    int fd = open("tests/test_html/100.htm", O_RDONLY);
+    struct stat fs;
+    fstat(fd, &fs);
+
+    char* html = malloc(fs.st_size);
+    read(fd, html, fs.st_size);
+    init_html_parser(&source);
+    html_buffer_append(&source._curl_buffer, html, fs.st_size);
+    free(html);
+    close(fd);
+}
+
+static void setup(void)
+{
+    load_source();
+    entries[0].link = "100_0001.htm";
+    entries[0].html = source._curl_buffer.html;
+    entries[0].size = source._curl_buffer.size;
+    map.latency_ms = 0;
+    init_page_loader(&settings);
+    loader_use_fetch(&settings, page_memory_fetch, &map);
+}
+
+static void teardown(void)
+{
+    free_page_loader(&settings);
+    free_html_parser(&source);
+}
+
+/**
+ * Wait until the slot of the link is in the state, at most 5 seconds
+ */
+static bool wait_for_slot(prefetcher* prefetch, const char* link, prefetch_state state)
+{
+    struct timespec pause = { 0, 1000000L };
+    for (int i = 0; i < 5000; i++) {
+        bool found = false;
+        pthread_mutex_lock(&prefetch->lock);
+        for (size_t j = 0; j < PREFETCH_SLOTS; j++) {
+            prefetch_slot* slot = &prefetch->slots[j];
+            if (slot->state == state && strcmp(slot->link, link) == 0)
+                found = true;
+        }
+        pthread_mutex_unlock(&prefetch->lock);
+        if (found)
+            return true;
+        nanosleep(&pause, NULL);
+    }
+
+    return false;
+}
+
+static bool take_page(prefetcher* prefetch, html_parser* parser, int page)
+{
+    link_from_ints(parser, page, 1);
+    return prefetch_take(prefetch, parser);
+}
+
+START_TEST(prefetch_ready_test)
+{
+    prefetcher prefetch;
+    init_prefetcher(&prefetch, &settings);
+    ck_assert_int_eq(prefetch.running, true);
+
+    char* links[] = { "100_0001.htm", "101_0001.htm" };
+    prefetch_links(&prefetch, links, 2);
+    ck_assert_int_eq(wait_for_slot(&prefetch, links[0], PREFETCH_READY), true);
+    ck_assert_int_eq(wait_for_slot(&prefetch, links[1], PREFETCH_READY), true);
+
+    html_parser parser;
+    init_html_parser(&parser);
+    ck_assert_int_eq(take_page(&prefetch, &parser, 100), true);
+    ck_assert_int_eq(parser.curl_load_error, false);
+    ck_assert_str_eq(parser.title.text, "Yle Teksti-TV | Sivu 100.1 ");
+    // Taken page is gone from the prefetcher
+    ck_assert_int_eq(take_page(&prefetch, &parser, 100), false);
+    // Pages that failed to load are not given out
+    ck_assert_int_eq(take_page(&prefetch, &parser, 101), false);
+    // Neither are the pages that were never prefetched
+    ck_assert_int_eq(take_page(&prefetch, &parser, 102), false);
+
+    free_html_parser(&parser);
+    free_prefetcher(&prefetch);
+}
+END_TEST
+
+START_TEST(prefetch_stale_test)
+{
+    prefetcher prefetch;
+    init_prefetcher(&prefetch, &settings);
+
+    char* links[] = { "100_0001.htm" };
+    prefetch_links(&prefetch, links, 1);
+    ck_assert_int_eq(wait_for_slot(&prefetch, links[0], PREFETCH_READY), true);
+
+    pthread_mutex_lock(&prefetch.lock);
+    for (size_t i = 0; i < PREFETCH_SLOTS; i++)
+        prefetch.slots[i].loaded_at -= PREFETCH_MAX_AGE + 1;
+    pthread_mutex_unlock(&prefetch.lock);
+
+    html_parser parser;
+    init_html_parser(&parser);
+    ck_assert_int_eq(take_page(&prefetch, &parser, 100), false);
+    ck_assert_int_eq(parser.curl_load_error, false);
+    // Stale page is dropped
+    ck_assert_int_eq(wait_for_slot(&prefetch, links[0], PREFETCH_READY), false);
+
+    free_html_parser(&parser);
+    free_prefetcher(&prefetch);
+}
+END_TEST
+
+START_TEST(prefetch_cancel_test)
+{
+    prefetcher prefetch;
+    init_prefetcher(&prefetch, &settings);
+
+    // Slow enough to be taken while loading
+    map.latency_ms = 300;
+    char* links[] = { "100_0001.htm" };
+    prefetch_links(&prefetch, links, 1);
+    ck_assert_int_eq(wait_for_slot(&prefetch, links[0], PREFETCH_LOADING), true);
+
+    // Loading page is cancelled instead of waited for
+    html_parser parser;
+    init_html_parser(&parser);
+    ck_assert_int_eq(take_page(&prefetch, &parser, 100), false);
+    ck_assert_int_eq(wait_for_slot(&prefetch, links[0], PREFETCH_EMPTY), true);
+    ck_assert_int_eq(__atomic_load_n(&prefetch.loader.cancel, __ATOMIC_ACQUIRE), 0);
+
+    // The cancelled load doesn't leak to the next one
+    map.latency_ms = 0;
+    prefetch_links(&prefetch, links, 1);
+    ck_assert_int_eq(wait_for_slot(&prefetch, links[0], PREFETCH_READY), true);
+    ck_assert_int_eq(take_page(&prefetch, &parser, 100), true);
+    ck_assert_str_eq(parser.title.text, "Yle Teksti-TV | Sivu 100.1 ");
+
+    free_html_parser(&parser);
+    free_prefetcher(&prefetch);
+}
+END_TEST
+
+Suite* prefetch_suite(void)
+{
+    Suite* s;
+    TCase* tc_core;
+
+    s = suite_create("Prefetch");
+    tc_core = tcase_create("Prefetch Core");
+    tcase_add_checked_fixture(tc_core, setup, teardown);
+
+    tcase_add_test(tc_core, prefetch_ready_test);
+    tcase_add_test(tc_core, prefetch_stale_test);
+    tcase_add_test(tc_core, prefetch_cancel_test);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite* s;
+    SRunner* sr;
+
+    s = prefetch_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,82 @@
+#include <check.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "../tools/work_pool.h"
+
+typedef struct {
+    size_t* runs;
+    size_t workers;
+    bool bad_worker;
+} pool_test;
+
+static void count_task(size_t task, size_t worker, void* data)
+{
+    pool_test* test = data;
+    __atomic_fetch_add(&test->runs[task], 1, __ATOMIC_RELAXED);
+    if (worker >= test->workers)
+        __atomic_store_n(&test->bad_worker, true, __ATOMIC_RELAXED);
+}
+
+static void run_pool_helper(size_t tasks, size_t workers)
+{
+    pool_test test;
+    test.runs = calloc(tasks > 0 ? tasks : 1, sizeof(size_t));
+    // The pool uses at least one worker
+    test.workers = workers > 0 ? workers : 1;
+    test.bad_worker = false;
+
+    run_work_pool(tasks, workers, count_task, &test);
+
+    for (size_t i = 0; i < tasks; i++)
+        ck_assert_msg(test.runs[i] == 1, "Task %zu of %zu ran %zu times with %zu workers", i, tasks, test.runs[i], workers);
+    ck_assert_int_eq(test.bad_worker, false);
+
+    free(test.runs);
+}
+
+START_TEST(work_pool_test)
+{
+    // No tasks
+    run_pool_helper(0, 0);
+    run_pool_helper(0, 4);
+    // More workers than tasks
+    run_pool_helper(1, 4);
+    run_pool_helper(3, 8);
+    // Uneven shares that need stealing
+    run_pool_helper(1, 1);
+    run_pool_helper(7, 3);
+    run_pool_helper(1000, 4);
+    run_pool_helper(1001, 16);
+}
+END_TEST
+
+Suite* work_pool_suite(void)
+{
+    Suite* s;
+    TCase* tc_core;
+
+    s = suite_create("Work pool");
+    tc_core = tcase_create("Work pool Core");
+
+    tcase_add_test(tc_core, work_pool_test);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite* s;
+    SRunner* sr;
+
+    s = work_pool_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
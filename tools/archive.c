@@ -0,0 +1,244 @@
+#define _POSIX_C_SOURCE 200809L
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <tekstitv.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "work_pool.h"
+
+typedef enum {
+    PAGE_OK,
+    // Not a teletext page, like the "YLE Teleport" page
+    PAGE_INVALID,
+    PAGE_UNREADABLE,
+} page_status;
+
+typedef struct {
+    char* path;
+    size_t size;
+    page_status status;
+    char title[HTML_TEXT_MAX];
+    size_t rows;
+    size_t links;
+    size_t sub_pages;
+} page_result;
+
+typedef struct {
+    page_result* pages;
+    size_t size;
+    size_t capacity;
+} page_list;
+
+typedef struct {
+    page_list* pages;
+    // Every thread has its own parser
+    html_parser* parsers;
+} archive_job;
+
+static const char* status_names[] = { "ok", "invalid", "unreadable" };
+
+static void print_usage(const char* name)
+{
+    printf("Usage: %s [options] <directory>\n", name);
+    printf("Parse every .htm file in the directory and its sub directories.\n\n");
+    printf("Options:\n");
+    printf("  -j, --jobs <count>   How many threads to use. Defaults to the number of cores\n");
+    printf("  -q, --quiet          Only print the summary\n");
+    printf("  -h, --help           Print this help\n\n");
+    printf("Every page is printed as a tab separated line:\n");
+    printf("  path, status (ok/invalid/unreadable), middle rows, links, sub pages, title\n");
+}
+
+static bool is_html_file(const char* name)
+{
+    size_t len = strlen(name);
+    return len > 4 && strcmp(name + len - 4, ".htm") == 0;
+}
+
+static bool add_page(page_list* list, const char* path, size_t size)
+{
+    if (list->size == list->capacity) {
+        size_t capacity = list->capacity > 0 ? list->capacity * 2 : 256;
+        page_result* pages = realloc(list->pages, sizeof(page_result) * capacity);
+        if (pages == NULL)
+            return false;
+        list->pages = pages;
+        list->capacity = capacity;
+    }
+
+    page_result* page = &list->pages[list->size];
+    memset(page, 0, sizeof(page_result));
+    page->path = strdup(path);
+    if (page->path == NULL)
+        return false;
+
+    page->size = size;
+    list->size++;
+    return true;
+}
+
+/**
+ * Collect the .htm files from the directory tree
+ */
+static bool find_pages(page_list* list, const char* dir_path)
+{
+    DIR* dir = opendir(dir_path);
+    if (dir == NULL) {
+        fprintf(stderr, "Cannot open directory %s\n", dir_path);
+        return false;
+    }
+
+    bool ok = true;
+    struct dirent* entry;
+    while (ok && (entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            continue;
+
+        size_t len = strlen(dir_path) + strlen(entry->d_name) + 2;
+        char* path = malloc(len);
+        if (path == NULL) {
+            ok = false;
+            break;
+        }
+        snprintf(path, len, "%s/%s", dir_path, entry->d_name);
+
+        struct stat st;
+        if (stat(path, &st) == 0) {
+            if (S_ISDIR(st.st_mode))
+                ok = find_pages(list, path);
+            else if (S_ISREG(st.st_mode) && is_html_file(entry->d_name))
+                ok = add_page(list, path, st.st_size);
+        }
+        free(path);
+    }
+
+    closedir(dir);
+    return ok;
+}
+
+static int compare_pages(const void* a, const void* b)
+{
+    return strcmp(((const page_result*)a)->path, ((const page_result*)b)->path);
+}
+
+static void parse_page(size_t task, size_t worker, void* data)
+{
+    archive_job* job = data;
+    page_result* page = &job->pages->pages[task];
+    html_parser* parser = &job->parsers[worker];
+
+    if (!parse_html_file(parser, page->path)) {
+        page->status = PAGE_UNREADABLE;
+        return;
+    }
+
+    if (parser->curl_load_error) {
+        page->status = PAGE_INVALID;
+        return;
+    }
+
+    page->status = PAGE_OK;
+    memcpy(page->title, parser->title.text, parser->title.size + 1);
+    page->rows = parser->middle_rows;
+    page->sub_pages = parser->sub_pages.size;
+    for (size_t i = 0; i < parser->middle_rows; i++) {
+        for (size_t j = 0; j < parser->middle[i].size; j++) {
+            if (parser->middle[i].items[j].type == HTML_LINK)
+                page->links++;
+        }
+    }
+    for (size_t i = 0; i < parser->sub_pages.size; i++) {
+        if (parser->sub_pages.items[i].type == HTML_LINK)
+            page->links++;
+    }
+}
+
+static double elapsed_seconds(struct timespec start, struct timespec end)
+{
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+int main(int argc, char** argv)
+{
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    bool quiet = false;
+    const char* dir = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (strcmp(argv[i], "-q") == 0 || strcmp(argv[i], "--quiet") == 0) {
+            quiet = true;
+        } else if (strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--jobs") == 0) {
+            char* end = NULL;
+            jobs = i + 1 < argc ? strtol(argv[++i], &end, 10) : 0;
+            if (end == NULL || *end != '\0' || jobs < 1) {
+                fprintf(stderr, "%s needs a positive number as an argument\n", argv[i - 1]);
+                return 1;
+            }
+        } else if (dir == NULL) {
+            dir = argv[i];
+        } else {
+            fprintf(stderr, "Unknown argument %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (dir == NULL) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (jobs < 1)
+        jobs = 1;
+
+    page_list pages = { NULL, 0, 0 };
+    if (!find_pages(&pages, dir))
+        return 1;
+
+    // Results are printed in the same order on every run
+    qsort(pages.pages, pages.size, sizeof(page_result), compare_pages);
+
+    archive_job job;
+    job.pages = &pages;
+    job.parsers = malloc(sizeof(html_parser) * jobs);
+    if (job.parsers == NULL)
+        return 1;
+    for (long i = 0; i < jobs; i++)
+        init_html_parser(&job.parsers[i]);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    run_work_pool(pages.size, jobs, parse_page, &job);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    size_t bytes = 0;
+    size_t counts[3] = { 0 };
+    for (size_t i = 0; i < pages.size; i++) {
+        page_result* page = &pages.pages[i];
+        bytes += page->size;
+        counts[page->status]++;
+        if (!quiet) {
+            printf("%s\t%s\t%zu\t%zu\t%zu\t%s\n", page->path, status_names[page->status],
+                page->rows, page->links, page->sub_pages, page->title);
+        }
+        free(page->path);
+    }
+
+    double seconds = elapsed_seconds(start, end);
+    double mb = bytes / (1024.0 * 1024.0);
+    fprintf(stderr, "Parsed %zu pages (%zu invalid, %zu unreadable), %.1f MB in %.3f s with %ld threads\n",
+        pages.size, counts[PAGE_INVALID], counts[PAGE_UNREADABLE], mb, seconds, jobs);
+    if (seconds > 0)
+        fprintf(stderr, "%.0f pages/s, %.1f MB/s\n", pages.size / seconds, mb / seconds);
+
+    for (long i = 0; i < jobs; i++)
+        free_html_parser(&job.parsers[i]);
+    free(job.parsers);
+    free(pages.pages);
+    return counts[PAGE_UNREADABLE] > 0 ? 1 : 0;
+}
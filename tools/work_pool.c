@@ -0,0 +1,131 @@
+#include <stdlib.h>
+
+#include "work_pool.h"
+
+typedef struct {
+    work_pool* pool;
+    size_t index;
+} worker_args;
+
+static bool take_task(work_queue* queue, size_t* task)
+{
+    bool found = false;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->front < queue->back) {
+        *task = queue->tasks[--queue->back];
+        found = true;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return found;
+}
+
+/**
+ * Give the front half of the victim's remaining tasks to the thief, whose
+ * queue is empty. Nothing is copied, the thief's queue is pointed at that
+ * slice of the victim's task array and the victim's front moves past it.
+ */
+static bool steal_tasks(work_queue* thief, work_queue* victim)
+{
+    pthread_mutex_lock(&victim->lock);
+    size_t remaining = victim->back - victim->front;
+    size_t count = (remaining + 1) / 2;
+    // Reuse the victim's task array, the stolen part isn't touched by it anymore
+    size_t* stolen = victim->tasks + victim->front;
+    victim->front += count;
+    pthread_mutex_unlock(&victim->lock);
+
+    if (count == 0)
+        return false;
+
+    pthread_mutex_lock(&thief->lock);
+    thief->tasks = stolen;
+    thief->front = 0;
+    thief->back = count;
+    pthread_mutex_unlock(&thief->lock);
+    return true;
+}
+
+static void* pool_worker(void* data)
+{
+    worker_args* args = data;
+    work_pool* pool = args->pool;
+    work_queue* own = &pool->queues[args->index];
+
+    while (true) {
+        size_t task;
+        while (take_task(own, &task))
+            pool->run(task, args->index, pool->data);
+
+        // Steal from the next workers first so the thieves spread out
+        bool stolen = false;
+        for (size_t i = 1; i < pool->workers && !stolen; i++)
+            stolen = steal_tasks(own, &pool->queues[(args->index + i) % pool->workers]);
+
+        // Tasks are only added at the start, so nothing is left when nothing can be stolen
+        if (!stolen)
+            break;
+    }
+
+    return NULL;
+}
+
+/**
+ * Run tasks 0..tasks-1 with the given amount of threads. Every worker
+ * starts with an equal share of the tasks and steals from the others
+ * once it runs out. Returns after every task has been run.
+ */
+void run_work_pool(size_t tasks, size_t workers, work_pool_task run, void* data)
+{
+    if (workers == 0)
+        workers = 1;
+    if (workers > tasks)
+        workers = tasks > 0 ? tasks : 1;
+
+    size_t* task_list = malloc(sizeof(size_t) * (tasks > 0 ? tasks : 1));
+    work_queue* queues = malloc(sizeof(work_queue) * workers);
+    pthread_t* threads = malloc(sizeof(pthread_t) * workers);
+    worker_args* args = malloc(sizeof(worker_args) * workers);
+    if (task_list == NULL || queues == NULL || threads == NULL || args == NULL) {
+        // Run everything on the calling thread instead
+        for (size_t i = 0; i < tasks; i++)
+            run(i, 0, data);
+        goto cleanup;
+    }
+
+    for (size_t i = 0; i < tasks; i++)
+        task_list[i] = i;
+
+    // Consecutive tasks go to the same worker
+    work_pool pool = { .queues = queues, .workers = workers, .run = run, .data = data };
+    for (size_t i = 0; i < workers; i++) {
+        size_t start = tasks * i / workers;
+        size_t end = tasks * (i + 1) / workers;
+        pthread_mutex_init(&queues[i].lock, NULL);
+        queues[i].tasks = task_list + start;
+        queues[i].front = 0;
+        queues[i].back = end - start;
+        args[i].pool = &pool;
+        args[i].index = i;
+    }
+
+    // The calling thread works as the first worker
+    size_t started = 1;
+    for (; started < workers; started++) {
+        if (pthread_create(&threads[started], NULL, pool_worker, &args[started]) != 0)
+            break;
+    }
+    pool_worker(&args[0]);
+
+    // Tasks of the workers that couldn't be started are stolen by the others
+    for (size_t i = 1; i < started; i++)
+        pthread_join(threads[i], NULL);
+
+    for (size_t i = 0; i < workers; i++)
+        pthread_mutex_destroy(&queues[i].lock);
+
+cleanup:
+    free(task_list);
+    free(queues);
+    free(threads);
+    free(args);
+}
@@ -0,0 +1,31 @@
+#ifndef _WORK_POOL_H_
+#define _WORK_POOL_H_
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Runs a single task. worker is the index of the thread running it
+typedef void (*work_pool_task)(size_t task, size_t worker, void* data);
+
+/**
+ * Tasks of a single worker. The owner takes the tasks from the back
+ * and the other workers steal them from the front.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    size_t* tasks;
+    size_t front;
+    size_t back;
+} work_queue;
+
+typedef struct {
+    work_queue* queues;
+    size_t workers;
+    work_pool_task run;
+    void* data;
+} work_pool;
+
+void run_work_pool(size_t tasks, size_t workers, work_pool_task run, void* data);
+
+#endif